@@ -15,6 +15,13 @@
 #define WSWRAP_WITH_COMPRESSION // default to compression enabled
 #endif
 
+#ifndef WSWRAP_DEFLATE_SERVER_MAX_WINDOW_BITS
+#define WSWRAP_DEFLATE_SERVER_MAX_WINDOW_BITS 12 // 4KiB window for incoming messages
+#endif
+#ifndef WSWRAP_DEFLATE_CLIENT_MAX_WINDOW_BITS
+#define WSWRAP_DEFLATE_CLIENT_MAX_WINDOW_BITS 10 // 1KiB window for outgoing messages
+#endif
+
 #include <string>
 #include <functional>
 #include <chrono>
@@ -43,11 +50,40 @@
 
 namespace wswrap {
 
+#ifdef WSWRAP_WITH_COMPRESSION
+    // websocketpp's permessage-deflate always offers the default 32KiB windows, whatever the configured limits.
+    // This one asks the server for a bounded window, so that the memory used by compression stays small.
+    template <typename config>
+    class bounded_permessage_deflate: public websocketpp::extensions::permessage_deflate::enabled<config> {
+    private:
+        typedef websocketpp::extensions::permessage_deflate::enabled<config> base;
+        typedef std::pair<websocketpp::lib::error_code, std::string> err_str_pair;
+
+    public:
+        std::string generate_offer() const
+        {
+            return "permessage-deflate; client_no_context_takeover"
+                   "; server_max_window_bits=" + std::to_string(WSWRAP_DEFLATE_SERVER_MAX_WINDOW_BITS) +
+                   "; client_max_window_bits=" + std::to_string(WSWRAP_DEFLATE_CLIENT_MAX_WINDOW_BITS);
+        }
+
+        err_str_pair negotiate(websocketpp::http::attribute_list const & response)
+        {
+            using namespace websocketpp::extensions::permessage_deflate;
+            // the server's window is whatever it says it is (32KiB if it doesn't say), even if it didn't honor
+            // the offer: decompressing with a smaller window than the one used for compression would fail
+            base::set_server_max_window_bits(max_server_max_window_bits, mode::accept);
+            // our own window can always be smaller than what the server allows
+            base::set_client_max_window_bits(WSWRAP_DEFLATE_CLIENT_MAX_WINDOW_BITS, mode::largest);
+            return base::negotiate(response);
+        }
+    };
+#endif
+
     struct client_config: public websocketpp::config::asio_client {
 #ifdef WSWRAP_WITH_COMPRESSION
         struct permessage_deflate_config {};
-        typedef websocketpp::extensions::permessage_deflate::enabled<permessage_deflate_config>
-            permessage_deflate_type;
+        typedef bounded_permessage_deflate<permessage_deflate_config> permessage_deflate_type;
 #endif
     };
 
@@ -55,8 +91,7 @@ namespace wswrap {
     struct tls_client_config: public websocketpp::config::asio_tls_client {
 #ifdef WSWRAP_WITH_COMPRESSION
         struct permessage_deflate_config {};
-        typedef websocketpp::extensions::permessage_deflate::enabled<permessage_deflate_config>
-            permessage_deflate_type;
+        typedef bounded_permessage_deflate<permessage_deflate_config> permessage_deflate_type;
 #endif
     };
 #endif
@@ -18,3 +18,4 @@ void connect_emu();
 void check_rom_existence(uint32_t seed, const std::string& player_name);
 std::string build_rom();
 void process_console_input(const std::string& input);
+void process_ui_events();
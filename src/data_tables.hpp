@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Plain data structures filled at build time by tools/data_table_generator from the JSON files in src/data, which
+ * are instantiated as constexpr tables in the generated headers of the same directory.
+ */
+
+struct LocationDefinition
+{
+    uint16_t id;
+    uint16_t checked_flag_byte;
+    uint8_t checked_flag_bit;
+};
+
+struct TrackableRegionDefinition
+{
+    const char* name;
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    /// Range of indices of the region's locations inside TRACKABLE_REGION_LOCATIONS
+    uint16_t first_location;
+    uint16_t location_count;
+    /// Bit N is set if the region must be hidden when goal N is selected
+    uint8_t hidden_for_goals;
+    const char* dark_dungeon_name;
+    const char* spawn_location_name;
+    const char* teleport_tree_name;
+};
+
+struct TrackableItemDefinition
+{
+    const char* name;
+    const char* image;
+    uint8_t item_id;
+    uint8_t quantity;
+    /// Position of the item in the item tracker, in icons
+    float x;
+    float y;
+};
@@ -5,6 +5,7 @@
 #include <utility>
 #include <iostream>
 #include <sstream>
+#include "game_ram_snapshot.hpp"
 #include "../logger.hpp"
 
 BizhawkMemInterface::BizhawkMemInterface()
@@ -62,6 +63,28 @@ uint32_t BizhawkMemInterface::read_game_long(uint16_t address) const
     return (msw << 16) + lsw;
 }
 
+void BizhawkMemInterface::read_game_block(uint16_t address, uint16_t size, uint8_t* output) const
+{
+    if(address % 2 != 0 || size % 2 != 0)
+        throw EmulatorException("Block reads from the emulator's memory must be word-aligned");
+
+    SIZE_T bytes_read;
+    LPCVOID addr = reinterpret_cast<LPCVOID>(_game_ram_base_address + address);
+    BOOL success = ReadProcessMemory(_process_handle, addr, output, size, &bytes_read);
+    if (!success || bytes_read != size)
+        throw EmulatorException("Failed to read data from the emulator's memory");
+
+    // RAM is stored as a sequence of native 16-bit words, swap bytes inside each word to get them in game order
+    for(uint16_t i=0 ; i<size ; i += 2)
+        std::swap(output[i], output[i+1]);
+}
+
+void BizhawkMemInterface::read_snapshot(GameRamSnapshot& snapshot) const
+{
+    for(const GameRamSnapshot::Block& block : snapshot.blocks())
+        this->read_game_block(block.address, block.size, snapshot.block_data(block));
+}
+
 void BizhawkMemInterface::write_game_byte(uint16_t address, uint8_t value)
 {
     uint16_t even_address = address - (address % 2);
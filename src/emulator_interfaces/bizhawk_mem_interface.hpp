@@ -21,6 +21,8 @@ public:
     [[nodiscard]] uint8_t read_game_byte(uint16_t address) const override;
     [[nodiscard]] uint16_t read_game_word(uint16_t address) const override;
     [[nodiscard]] uint32_t read_game_long(uint16_t address) const override;
+    void read_game_block(uint16_t address, uint16_t size, uint8_t* output) const override;
+    void read_snapshot(GameRamSnapshot& snapshot) const override;
 
     void write_game_byte(uint16_t address, uint8_t value) override;
     void write_game_word(uint16_t address, uint16_t value) override;
@@ -3,6 +3,8 @@
 #include <vector>
 #include <string>
 
+class GameRamSnapshot;
+
 class EmulatorException : public std::exception {
 private:
     std::string _msg;
@@ -21,6 +23,12 @@ public:
     [[nodiscard]] virtual uint16_t read_game_word(uint16_t address) const = 0;
     [[nodiscard]] virtual uint32_t read_game_long(uint16_t address) const = 0;
 
+    /// Read a contiguous block of game RAM in a single memory access. Bytes are output in game order (big-endian).
+    /// Both address and size must be even.
+    virtual void read_game_block(uint16_t address, uint16_t size, uint8_t* output) const = 0;
+    /// Fill all blocks of the given snapshot using as few memory accesses as possible
+    virtual void read_snapshot(GameRamSnapshot& snapshot) const = 0;
+
     virtual void write_game_byte(uint16_t address, uint8_t value) = 0;
     virtual void write_game_word(uint16_t address, uint16_t value) = 0;
     virtual void write_game_long(uint16_t address, uint32_t value) = 0;
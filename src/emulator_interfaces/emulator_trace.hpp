@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Binary format used to record emulator sessions (see RecordingEmulatorInterface) and play them back
+ * (see ReplayEmulatorInterface). All values are stored little-endian.
+ *
+ * File starts with the 4 bytes "RSTR" followed by the format version (1 byte). Then comes a sequence of records,
+ * each one starting with its type (1 byte) and its timestamp in milliseconds since the start of the recording
+ * (4 bytes), followed by:
+ *  - READ_BYTE / READ_WORD / READ_LONG: address (2 bytes), value read (1, 2 or 4 bytes)
+ *  - WRITE_BYTE / WRITE_WORD / WRITE_LONG: address (2 bytes), value written (1, 2 or 4 bytes)
+ *  - READ_BLOCK: one block (see below)
+ *  - READ_SNAPSHOT: block count (1 byte), then each block
+ *
+ * A block is made of its address (2 bytes), its size (2 bytes) and an encoding byte. If encoding is
+ * BLOCK_UNCHANGED, contents are the same as the last recorded block with same address and size and are omitted.
+ * If encoding is BLOCK_RAW, `size` bytes of contents follow, in game order.
+ */
+namespace emulator_trace
+{
+    constexpr char MAGIC[4] = { 'R', 'S', 'T', 'R' };
+    constexpr uint8_t VERSION = 1;
+
+    enum class RecordType : uint8_t
+    {
+        READ_BYTE = 0,
+        READ_WORD = 1,
+        READ_LONG = 2,
+        READ_BLOCK = 3,
+        READ_SNAPSHOT = 4,
+        WRITE_BYTE = 5,
+        WRITE_WORD = 6,
+        WRITE_LONG = 7
+    };
+
+    constexpr uint8_t BLOCK_UNCHANGED = 0;
+    constexpr uint8_t BLOCK_RAW = 1;
+
+    /// Key used to identify blocks with the same address and size across records
+    constexpr uint32_t block_key(uint16_t address, uint16_t size) { return (static_cast<uint32_t>(address) << 16) | size; }
+}
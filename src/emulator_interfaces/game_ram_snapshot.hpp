@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "emulator_interface.hpp"
+
+/**
+ * A local copy of one or several blocks of the game's work RAM, taken all at once through
+ * EmulatorInterface::read_snapshot. Once taken, all values can be decoded from the snapshot without any further
+ * access to the emulator's memory.
+ * Bytes are stored in game order (big-endian), regardless of how the emulator stores them internally.
+ */
+class GameRamSnapshot
+{
+public:
+    struct Block
+    {
+        uint16_t address;
+        uint16_t size;
+        uint32_t offset;
+    };
+
+private:
+    std::vector<Block> _blocks;
+    std::vector<uint8_t> _data;
+
+public:
+    GameRamSnapshot() = default;
+
+    /// Add a block of RAM to be copied when taking the snapshot. Address and size must both be even.
+    void add_block(uint16_t address, uint16_t size)
+    {
+        if(address % 2 != 0 || size % 2 != 0)
+            throw EmulatorException("RAM snapshot blocks must be word-aligned");
+
+        _blocks.emplace_back(Block { .address = address, .size = size, .offset = (uint32_t)_data.size() });
+        _data.resize(_data.size() + size, 0x00);
+    }
+
+    [[nodiscard]] const std::vector<Block>& blocks() const { return _blocks; }
+    [[nodiscard]] uint8_t* block_data(const Block& block) { return _data.data() + block.offset; }
+
+    [[nodiscard]] bool contains(uint16_t address, uint16_t size = 1) const
+    {
+        return this->find_block(address, size) != nullptr;
+    }
+
+    [[nodiscard]] uint8_t byte(uint16_t address) const
+    {
+        return _data[this->data_offset(address, 1)];
+    }
+
+    [[nodiscard]] uint16_t word(uint16_t address) const
+    {
+        uint32_t offset = this->data_offset(address, 2);
+        return (static_cast<uint16_t>(_data[offset]) << 8) + _data[offset+1];
+    }
+
+    [[nodiscard]] uint32_t long_value(uint16_t address) const
+    {
+        uint32_t offset = this->data_offset(address, 4);
+        return (static_cast<uint32_t>(_data[offset]) << 24) + (static_cast<uint32_t>(_data[offset+1]) << 16)
+             + (static_cast<uint32_t>(_data[offset+2]) << 8) + _data[offset+3];
+    }
+
+    /// Direct access to a contiguous range of bytes of the snapshot, in game order
+    [[nodiscard]] const uint8_t* bytes(uint16_t address, uint16_t size) const
+    {
+        return _data.data() + this->data_offset(address, size);
+    }
+
+private:
+    [[nodiscard]] const Block* find_block(uint16_t address, uint16_t size) const
+    {
+        for(const Block& block : _blocks)
+            if(address >= block.address && (uint32_t)address + size <= (uint32_t)block.address + block.size)
+                return &block;
+        return nullptr;
+    }
+
+    [[nodiscard]] uint32_t data_offset(uint16_t address, uint16_t size) const
+    {
+        const Block* block = this->find_block(address, size);
+        if(!block)
+            throw EmulatorException("Tried to read an address which is not part of the RAM snapshot");
+        return block->offset + (address - block->address);
+    }
+};
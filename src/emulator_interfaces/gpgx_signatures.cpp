@@ -0,0 +1,276 @@
+#include "gpgx_signatures.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include "emulator_interface.hpp"
+#include "signature_scanner.hpp"
+#include "../logger.hpp"
+
+using nlohmann::json;
+
+/// File where signatures found on previous attaches are stored, indexed by core module
+#define SIGNATURE_CACHE_FILE "./emulator_cache.json"
+
+const std::vector<GpgxSignature> GPGX_SIGNATURES = {
+    {
+        "RA 1.9.0 - GPGX 1.7.4 [7fa34f2] - 64 bit",
+        {
+            0x85, 0xC9, 0x74, ANY_BYTE, 0x83, 0xF9, 0x02, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x48, 0x0F, 0x44, 0x05,
+            ANY_BYTE, ANY_BYTE, ANY_BYTE, ANY_BYTE, 0xC3
+        },
+        16, GpgxSignature::PointerType::RELATIVE_POINTER_64
+    },
+    {
+        "RA 1.13.0 - GPGX 1.7.4 [7907766] - 64 bit",
+        {
+            0x85, 0xC9, 0x74, ANY_BYTE, 0x31, 0xC0, 0x83, 0xF9, 0x02, 0x48, 0x0F, 0x44, 0x05,
+            ANY_BYTE, ANY_BYTE, ANY_BYTE, ANY_BYTE, 0xC3
+        },
+        13, GpgxSignature::PointerType::RELATIVE_POINTER_64
+    },
+    {
+        "RA 1.15.0 - GPGX 1.7.4 [9745432] - 32 bit",
+        {
+            0x8B, 0x54, 0x24, 0x04, 0x85, 0xD2, 0x74, ANY_BYTE, 0x83, 0xFA, 0x02, 0xB8, ANY_BYTE, ANY_BYTE, ANY_BYTE,
+            ANY_BYTE, 0xBA, 0x00, 0x00, 0x00, 0x00
+        },
+        12, GpgxSignature::PointerType::ABSOLUTE_ADDRESS_32
+    },
+    {
+        "???",
+        {
+            0x8B, 0x44, 0x24, 0x04, 0x85, 0xC0, 0x74, 0x18, 0x83, 0xF8, 0x02, 0xBA, 0x00, 0x00, 0x00, 0x00, 0xB8,
+            ANY_BYTE, ANY_BYTE, ANY_BYTE, ANY_BYTE, 0x0F, 0x45, 0xC2, 0xC3, 0x8D, 0xB4, 0x26, 0x00, 0x00, 0x00, 0x00
+        },
+        17, GpgxSignature::PointerType::RELATIVE_POINTER_32
+    }
+};
+
+const std::vector<GpgxSignature> GPGX_RETURN_SIGNATURES = {
+    {
+        "lea rax, [rip+work_ram] ; mov rax, [rax] ; ret",
+        { 0x48, 0x8D, 0x05, ANY_BYTE, ANY_BYTE, ANY_BYTE, ANY_BYTE, 0x48, 0x8B, 0x00, 0xC3 },
+        3, GpgxSignature::PointerType::RELATIVE_POINTER_64
+    },
+    {
+        "mov rax, [rip+work_ram@GOT] ; mov rax, [rax] ; ret",
+        { 0x48, 0x8B, 0x05, ANY_BYTE, ANY_BYTE, ANY_BYTE, ANY_BYTE, 0x48, 0x8B, 0x00, 0xC3 },
+        3, GpgxSignature::PointerType::RELATIVE_GOT_ENTRY_64
+    },
+    {
+        "cmove rax, [rip+work_ram] ; ret",
+        { 0x48, 0x0F, 0x44, 0x05, ANY_BYTE, ANY_BYTE, ANY_BYTE, ANY_BYTE, 0xC3 },
+        4, GpgxSignature::PointerType::RELATIVE_POINTER_64
+    },
+    {
+        "mov rax, [rip+work_ram] ; xor edx, edx ; cmp edi, 2 ; cmovne rax, rdx ; ret",
+        {
+            0x48, 0x8B, 0x05, ANY_BYTE, ANY_BYTE, ANY_BYTE, ANY_BYTE, 0x31, 0xD2, 0x83, 0xFF, 0x02, 0x48, 0x0F, 0x45,
+            0xC2, 0xC3
+        },
+        3, GpgxSignature::PointerType::RELATIVE_POINTER_64
+    },
+    {
+        "mov rax, [rip+work_ram] ; ret",
+        { 0x48, 0x8B, 0x05, ANY_BYTE, ANY_BYTE, ANY_BYTE, ANY_BYTE, 0xC3 },
+        3, GpgxSignature::PointerType::RELATIVE_POINTER_64
+    },
+    {
+        "lea rax, [rip+work_ram] ; ret",
+        { 0x48, 0x8D, 0x05, ANY_BYTE, ANY_BYTE, ANY_BYTE, ANY_BYTE, 0xC3 },
+        3, GpgxSignature::PointerType::RELATIVE_ADDRESS_64
+    }
+};
+
+uint64_t resolve_gpgx_ram_base_addr(const GpgxSignature& signature, uint64_t signature_addr,
+                                    const ProcessMemoryReader& read)
+{
+    uint64_t operand_addr = signature_addr + signature.operand_offset;
+
+    uint32_t operand = 0;
+    if(!read(operand_addr, &operand, sizeof(operand)))
+        throw EmulatorException("Failed to read data from the emulator's memory");
+
+    if(signature.pointer_type == GpgxSignature::PointerType::ABSOLUTE_ADDRESS_32)
+        return operand;
+
+    // Displacement is relative to the end of the operand, and can be negative
+    uint64_t pointer_addr = operand_addr + 4 + static_cast<int64_t>(static_cast<int32_t>(operand));
+    if(signature.pointer_type == GpgxSignature::PointerType::RELATIVE_ADDRESS_64)
+        return pointer_addr;
+
+    if(signature.pointer_type == GpgxSignature::PointerType::RELATIVE_GOT_ENTRY_64)
+    {
+        if(!read(pointer_addr, &pointer_addr, sizeof(pointer_addr)))
+            throw EmulatorException("Failed to read data from the emulator's memory");
+    }
+    else if(signature.pointer_type == GpgxSignature::PointerType::RELATIVE_POINTER_32)
+    {
+        uint32_t pointer = 0;
+        if(!read(pointer_addr, &pointer, sizeof(pointer)))
+            throw EmulatorException("Failed to read data from the emulator's memory");
+        return pointer;
+    }
+
+    uint64_t pointer = 0;
+    if(!read(pointer_addr, &pointer, sizeof(pointer)))
+        throw EmulatorException("Failed to read data from the emulator's memory");
+    return pointer;
+}
+
+/**
+ * Build a key identifying a given build of the core, which is used to know if a cached signature can be reused
+ */
+static std::string build_module_key(const std::string& module_path)
+{
+    std::error_code error;
+    std::filesystem::path path(module_path);
+    uintmax_t file_size = std::filesystem::file_size(path, error);
+    if(error)
+        return "";
+    auto timestamp = std::filesystem::last_write_time(path, error);
+    if(error)
+        return "";
+
+    return module_path + "|" + std::to_string(file_size) + "|" + std::to_string(timestamp.time_since_epoch().count());
+}
+
+static json load_signature_cache()
+{
+    std::ifstream cache_file(SIGNATURE_CACHE_FILE);
+    if(!cache_file.is_open())
+        return json::object();
+
+    try
+    {
+        json cache;
+        cache_file >> cache;
+        if(cache.is_object())
+            return cache;
+    }
+    catch(json::exception&) {}
+
+    return json::object();
+}
+
+/**
+ * Try resolving the RAM address using the signature that was found during a previous attach to the same core build.
+ * Signature is checked to still be there before being used, and UINT64_MAX is returned if anything looks wrong.
+ */
+static uint64_t find_gpgx_ram_base_addr_from_cache(const json& cache_entry, uint64_t module_base,
+                                                   const ProcessMemoryReader& read)
+{
+    try
+    {
+        size_t signature_id = cache_entry.at("signature");
+        uint64_t offset = cache_entry.at("offset");
+        if(signature_id >= GPGX_SIGNATURES.size())
+            return UINT64_MAX;
+
+        const GpgxSignature& signature = GPGX_SIGNATURES[signature_id];
+        uint64_t signature_addr = module_base + offset;
+
+        std::vector<uint8_t> data(signature.pattern.size());
+        if(!read(signature_addr, data.data(), data.size()))
+            return UINT64_MAX;
+        for(size_t i=0 ; i<data.size() ; ++i)
+            if(signature.pattern[i] != ANY_BYTE && data[i] != signature.pattern[i])
+                return UINT64_MAX;
+
+        Logger::debug("Found cached GPGX signature " + std::to_string(signature_id+1) + " (" + signature.description + ")");
+        return resolve_gpgx_ram_base_addr(signature, signature_addr, read);
+    }
+    catch(json::exception&) {}
+    catch(EmulatorException&) {}
+
+    return UINT64_MAX;
+}
+
+uint64_t find_gpgx_ram_base_addr(const std::string& module_path, const std::vector<MemoryRange>& ranges,
+                                 const ProcessMemoryReader& read)
+{
+    if(ranges.empty())
+        return UINT64_MAX;
+
+    // Signature positions are stored relatively to the start of the module, since it can be loaded anywhere
+    const uint64_t module_base = ranges.front().base;
+    const std::string module_key = build_module_key(module_path);
+
+    json cache = load_signature_cache();
+    if(!module_key.empty() && cache.contains(module_key))
+    {
+        uint64_t addr = find_gpgx_ram_base_addr_from_cache(cache.at(module_key), module_base, read);
+        if(addr != UINT64_MAX)
+            return addr;
+    }
+
+    // Look for all known signatures at once, and only keep the first one in table order if several are found
+    static const SignatureScanner scanner = []() {
+        SignatureScanner gpgx_scanner;
+        for(const GpgxSignature& signature : GPGX_SIGNATURES)
+            gpgx_scanner.add_pattern(signature.pattern);
+        return gpgx_scanner;
+    }();
+
+    std::vector<uint64_t> signature_addresses = scanner.scan(ranges, read);
+    for(size_t i=0 ; i<GPGX_SIGNATURES.size() ; ++i)
+    {
+        if(signature_addresses[i] != UINT64_MAX)
+        {
+            const GpgxSignature& signature = GPGX_SIGNATURES[i];
+            Logger::debug("Found GPGX signature " + std::to_string(i+1) + " (" + signature.description + ")");
+            uint64_t ram_base_addr = resolve_gpgx_ram_base_addr(signature, signature_addresses[i], read);
+
+            if(!module_key.empty())
+            {
+                // Entries for previous builds of the same core will never match again, only the latest one is kept
+                const std::string module_path_prefix = module_path + "|";
+                for(auto it = cache.begin() ; it != cache.end() ; )
+                {
+                    if(it.key().starts_with(module_path_prefix))
+                        it = cache.erase(it);
+                    else
+                        ++it;
+                }
+
+                cache[module_key] = {
+                    { "signature", i },
+                    { "offset", signature_addresses[i] - module_base }
+                };
+                std::ofstream cache_file(SIGNATURE_CACHE_FILE);
+                if(cache_file)
+                    cache_file << cache.dump(4);
+            }
+
+            return ram_base_addr;
+        }
+    }
+
+    return UINT64_MAX;
+}
+
+uint64_t find_gpgx_ram_base_addr_in_function(const MemoryRange& function, const ProcessMemoryReader& read)
+{
+    static const SignatureScanner scanner = []() {
+        SignatureScanner gpgx_scanner;
+        for(const GpgxSignature& signature : GPGX_RETURN_SIGNATURES)
+            gpgx_scanner.add_pattern(signature.pattern);
+        return gpgx_scanner;
+    }();
+
+    // Save RAM is returned through a field of the `sram` structure (with a non-zero offset), which doesn't match any
+    // of these signatures
+    std::vector<uint64_t> signature_addresses = scanner.scan({ function }, read);
+    for(size_t i=0 ; i<GPGX_RETURN_SIGNATURES.size() ; ++i)
+    {
+        if(signature_addresses[i] != UINT64_MAX)
+        {
+            const GpgxSignature& signature = GPGX_RETURN_SIGNATURES[i];
+            Logger::debug("Found GPGX return signature " + std::to_string(i+1) + " (" + signature.description + ")");
+            return resolve_gpgx_ram_base_addr(signature, signature_addresses[i], read);
+        }
+    }
+
+    return UINT64_MAX;
+}
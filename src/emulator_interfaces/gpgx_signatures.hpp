@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <string>
+
+/// Function used to read inside the memory of the emulator process, returning false if the read failed
+using ProcessMemoryReader = std::function<bool(uint64_t address, void* output, size_t size)>;
+
+struct MemoryRange
+{
+    uint64_t base;
+    uint64_t size;
+};
+
+/**
+ * A known sequence of instructions inside Genesis Plus GX core, located in the function returning the address
+ * of the work RAM. Once the signature is found, the RAM address can be deduced from the operand found at
+ * `operand_offset` bytes after the start of the signature.
+ */
+struct GpgxSignature
+{
+    enum class PointerType
+    {
+        RELATIVE_POINTER_64,    ///< Operand is a displacement to a 64-bit pointer to RAM
+        RELATIVE_GOT_ENTRY_64,  ///< Operand is a displacement to a GOT entry holding the address of a pointer to RAM
+        RELATIVE_ADDRESS_64,    ///< Operand is a displacement to RAM itself
+        RELATIVE_POINTER_32,    ///< Operand is a displacement to a 32-bit pointer to RAM
+        ABSOLUTE_ADDRESS_32     ///< Operand is the 32-bit address of RAM itself
+    };
+
+    const char* description;
+    std::vector<uint16_t> pattern;
+    uint8_t operand_offset;
+    PointerType pointer_type;
+};
+
+/// Value used inside signature patterns to represent "any byte"
+constexpr uint16_t ANY_BYTE = 0xFFFF;
+
+extern const std::vector<GpgxSignature> GPGX_SIGNATURES;
+
+/**
+ * Shorter signatures of the instructions returning the work RAM in 64-bit System V builds of the core (Linux),
+ * which are too common to be searched in the whole module: they are only searched inside `retro_get_memory_data`.
+ */
+extern const std::vector<GpgxSignature> GPGX_RETURN_SIGNATURES;
+
+uint64_t resolve_gpgx_ram_base_addr(const GpgxSignature& signature, uint64_t signature_addr,
+                                    const ProcessMemoryReader& read);
+uint64_t find_gpgx_ram_base_addr(const std::string& module_path, const std::vector<MemoryRange>& ranges,
+                                 const ProcessMemoryReader& read);
+uint64_t find_gpgx_ram_base_addr_in_function(const MemoryRange& function, const ProcessMemoryReader& read);
@@ -0,0 +1,134 @@
+#include "recording_emulator_interface.hpp"
+
+#include "game_ram_snapshot.hpp"
+
+using emulator_trace::RecordType;
+
+RecordingEmulatorInterface::RecordingEmulatorInterface(EmulatorInterface* emulator, const std::string& path) :
+    _emulator   (emulator),
+    _file       (path, std::ios::binary),
+    _start_time (std::chrono::steady_clock::now())
+{
+    if(!_file)
+        throw EmulatorException("Could not open trace file '" + path + "' for writing");
+
+    _file.write(emulator_trace::MAGIC, sizeof(emulator_trace::MAGIC));
+    this->write_value(emulator_trace::VERSION, 1);
+}
+
+RecordingEmulatorInterface::~RecordingEmulatorInterface()
+{
+    delete _emulator;
+}
+
+EmulatorInterface* RecordingEmulatorInterface::release()
+{
+    EmulatorInterface* emulator = _emulator;
+    _emulator = nullptr;
+    _file.close();
+    return emulator;
+}
+
+uint8_t RecordingEmulatorInterface::read_game_byte(uint16_t address) const
+{
+    uint8_t value = _emulator->read_game_byte(address);
+    this->write_record_header(RecordType::READ_BYTE);
+    this->write_value(address, 2);
+    this->write_value(value, 1);
+    return value;
+}
+
+uint16_t RecordingEmulatorInterface::read_game_word(uint16_t address) const
+{
+    uint16_t value = _emulator->read_game_word(address);
+    this->write_record_header(RecordType::READ_WORD);
+    this->write_value(address, 2);
+    this->write_value(value, 2);
+    return value;
+}
+
+uint32_t RecordingEmulatorInterface::read_game_long(uint16_t address) const
+{
+    uint32_t value = _emulator->read_game_long(address);
+    this->write_record_header(RecordType::READ_LONG);
+    this->write_value(address, 2);
+    this->write_value(value, 4);
+    return value;
+}
+
+void RecordingEmulatorInterface::read_game_block(uint16_t address, uint16_t size, uint8_t* output) const
+{
+    _emulator->read_game_block(address, size, output);
+    this->write_record_header(RecordType::READ_BLOCK);
+    this->write_block(address, size, output);
+}
+
+void RecordingEmulatorInterface::read_snapshot(GameRamSnapshot& snapshot) const
+{
+    _emulator->read_snapshot(snapshot);
+
+    if(snapshot.blocks().size() > UINT8_MAX)
+        throw EmulatorException("Too many blocks inside RAM snapshot to be recorded");
+
+    this->write_record_header(RecordType::READ_SNAPSHOT);
+    this->write_value(snapshot.blocks().size(), 1);
+    for(const GameRamSnapshot::Block& block : snapshot.blocks())
+        this->write_block(block.address, block.size, snapshot.block_data(block));
+}
+
+void RecordingEmulatorInterface::write_game_byte(uint16_t address, uint8_t value)
+{
+    _emulator->write_game_byte(address, value);
+    this->write_record_header(RecordType::WRITE_BYTE);
+    this->write_value(address, 2);
+    this->write_value(value, 1);
+}
+
+void RecordingEmulatorInterface::write_game_word(uint16_t address, uint16_t value)
+{
+    _emulator->write_game_word(address, value);
+    this->write_record_header(RecordType::WRITE_WORD);
+    this->write_value(address, 2);
+    this->write_value(value, 2);
+}
+
+void RecordingEmulatorInterface::write_game_long(uint16_t address, uint32_t value)
+{
+    _emulator->write_game_long(address, value);
+    this->write_record_header(RecordType::WRITE_LONG);
+    this->write_value(address, 2);
+    this->write_value(value, 4);
+}
+
+void RecordingEmulatorInterface::write_record_header(RecordType type) const
+{
+    auto elapsed = std::chrono::steady_clock::now() - _start_time;
+    auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+
+    this->write_value(static_cast<uint8_t>(type), 1);
+    this->write_value(static_cast<uint32_t>(timestamp), 4);
+}
+
+void RecordingEmulatorInterface::write_value(uint32_t value, uint8_t size) const
+{
+    for(uint8_t i=0 ; i<size ; ++i)
+        _file.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+}
+
+void RecordingEmulatorInterface::write_block(uint16_t address, uint16_t size, const uint8_t* data) const
+{
+    this->write_value(address, 2);
+    this->write_value(size, 2);
+
+    // Most blocks are polled again and again without changing, only store their contents when they did change
+    std::vector<uint8_t>& last_contents = _last_blocks[emulator_trace::block_key(address, size)];
+    if(last_contents.size() == size && std::equal(last_contents.begin(), last_contents.end(), data))
+    {
+        this->write_value(emulator_trace::BLOCK_UNCHANGED, 1);
+        return;
+    }
+
+    last_contents.assign(data, data + size);
+    this->write_value(emulator_trace::BLOCK_RAW, 1);
+    _file.write(reinterpret_cast<const char*>(data), size);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "emulator_interface.hpp"
+#include "emulator_trace.hpp"
+
+/**
+ * Wraps another emulator interface, forwarding every call to it while logging all reads and writes with their
+ * timestamp inside a trace file, which can later be played back using ReplayEmulatorInterface.
+ */
+class RecordingEmulatorInterface : public EmulatorInterface
+{
+private:
+    EmulatorInterface* _emulator;
+    mutable std::ofstream _file;
+    std::chrono::steady_clock::time_point _start_time;
+
+    /// Last contents recorded for each block, used to omit blocks that did not change since last time
+    mutable std::map<uint32_t, std::vector<uint8_t>> _last_blocks;
+
+public:
+    /// Start recording into the given file. Wrapped emulator is owned by this object from then on.
+    RecordingEmulatorInterface(EmulatorInterface* emulator, const std::string& path);
+    ~RecordingEmulatorInterface() override;
+
+    /// Stop recording and give back the wrapped emulator, which is not owned by this object anymore
+    EmulatorInterface* release();
+
+    [[nodiscard]] uint8_t read_game_byte(uint16_t address) const override;
+    [[nodiscard]] uint16_t read_game_word(uint16_t address) const override;
+    [[nodiscard]] uint32_t read_game_long(uint16_t address) const override;
+    void read_game_block(uint16_t address, uint16_t size, uint8_t* output) const override;
+    void read_snapshot(GameRamSnapshot& snapshot) const override;
+
+    void write_game_byte(uint16_t address, uint8_t value) override;
+    void write_game_word(uint16_t address, uint16_t value) override;
+    void write_game_long(uint16_t address, uint32_t value) override;
+
+private:
+    void write_record_header(emulator_trace::RecordType type) const;
+    void write_value(uint32_t value, uint8_t size) const;
+    void write_block(uint16_t address, uint16_t size, const uint8_t* data) const;
+};
@@ -0,0 +1,200 @@
+#include "replay_emulator_interface.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "game_ram_snapshot.hpp"
+
+using emulator_trace::RecordType;
+
+/// Size of the header preceding every record (type + timestamp)
+constexpr size_t RECORD_HEADER_SIZE = 5;
+
+ReplayEmulatorInterface::ReplayEmulatorInterface(const std::string& path, bool real_time) :
+    _real_time  (real_time),
+    _start_time (std::chrono::steady_clock::now())
+{
+    std::ifstream file(path, std::ios::binary);
+    if(!file)
+        throw EmulatorException("Could not open trace file '" + path + "'");
+
+    _trace.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if(_trace.size() < sizeof(emulator_trace::MAGIC) + 1
+    || std::memcmp(_trace.data(), emulator_trace::MAGIC, sizeof(emulator_trace::MAGIC)) != 0)
+        throw EmulatorException("File '" + path + "' is not a valid trace file");
+
+    _position = sizeof(emulator_trace::MAGIC);
+    if(this->next_value(1) != emulator_trace::VERSION)
+        throw EmulatorException("Trace file '" + path + "' was recorded using an unsupported version");
+}
+
+uint8_t ReplayEmulatorInterface::read_game_byte(uint16_t address) const
+{
+    this->advance();
+    return static_cast<uint8_t>(this->ram_value(address, 1));
+}
+
+uint16_t ReplayEmulatorInterface::read_game_word(uint16_t address) const
+{
+    this->advance();
+    return static_cast<uint16_t>(this->ram_value(address, 2));
+}
+
+uint32_t ReplayEmulatorInterface::read_game_long(uint16_t address) const
+{
+    this->advance();
+    return this->ram_value(address, 4);
+}
+
+void ReplayEmulatorInterface::read_game_block(uint16_t address, uint16_t size, uint8_t* output) const
+{
+    if(address % 2 != 0 || size % 2 != 0)
+        throw EmulatorException("Block reads from the emulator's memory must be word-aligned");
+
+    this->advance();
+    std::memcpy(output, _ram.data() + address, std::min<size_t>(size, _ram.size() - address));
+}
+
+void ReplayEmulatorInterface::read_snapshot(GameRamSnapshot& snapshot) const
+{
+    this->advance();
+    for(const GameRamSnapshot::Block& block : snapshot.blocks())
+        std::memcpy(snapshot.block_data(block), _ram.data() + block.address,
+                    std::min<size_t>(block.size, _ram.size() - block.address));
+}
+
+void ReplayEmulatorInterface::write_game_byte(uint16_t address, uint8_t value)
+{
+    this->set_ram_value(address, value, 1);
+}
+
+void ReplayEmulatorInterface::write_game_word(uint16_t address, uint16_t value)
+{
+    this->set_ram_value(address, value, 2);
+}
+
+void ReplayEmulatorInterface::write_game_long(uint16_t address, uint32_t value)
+{
+    this->set_ram_value(address, value, 4);
+}
+
+void ReplayEmulatorInterface::advance() const
+{
+    if(_position >= _trace.size())
+        throw EmulatorException("Replay is over.");
+
+    if(_real_time)
+    {
+        auto elapsed = std::chrono::steady_clock::now() - _start_time;
+        auto elapsed_millis = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+        while(_position < _trace.size() && this->next_timestamp() <= elapsed_millis)
+            this->apply_next_record();
+    }
+    else
+    {
+        while(_position < _trace.size())
+            if(this->apply_next_record())
+                return;
+
+        // Only writes were remaining inside the trace, there is nothing left to read
+        throw EmulatorException("Replay is over.");
+    }
+}
+
+bool ReplayEmulatorInterface::apply_next_record() const
+{
+    auto type = static_cast<RecordType>(this->next_value(1));
+    (void)this->next_value(4); // Timestamp
+
+    switch(type)
+    {
+        case RecordType::READ_BYTE:
+        case RecordType::READ_WORD:
+        case RecordType::READ_LONG:
+        {
+            uint8_t size = (type == RecordType::READ_BYTE) ? 1 : (type == RecordType::READ_WORD) ? 2 : 4;
+            uint16_t address = this->next_value(2);
+            this->set_ram_value(address, this->next_value(size), size);
+            return true;
+        }
+        case RecordType::READ_BLOCK:
+            this->apply_block();
+            return true;
+        case RecordType::READ_SNAPSHOT:
+        {
+            uint8_t block_count = this->next_value(1);
+            for(uint8_t i=0 ; i<block_count ; ++i)
+                this->apply_block();
+            return true;
+        }
+        case RecordType::WRITE_BYTE:
+        case RecordType::WRITE_WORD:
+        case RecordType::WRITE_LONG:
+        {
+            // Writes made by the client during the recorded session are replaced by the ones made during replay
+            uint8_t size = (type == RecordType::WRITE_BYTE) ? 1 : (type == RecordType::WRITE_WORD) ? 2 : 4;
+            _position += 2 + size;
+            return false;
+        }
+    }
+
+    throw EmulatorException("Unknown record type found inside trace file");
+}
+
+void ReplayEmulatorInterface::apply_block() const
+{
+    uint16_t address = this->next_value(2);
+    uint16_t size = this->next_value(2);
+    uint8_t encoding = this->next_value(1);
+
+    std::vector<uint8_t>& contents = _last_blocks[emulator_trace::block_key(address, size)];
+    if(encoding == emulator_trace::BLOCK_RAW)
+    {
+        if(_position + size > _trace.size())
+            throw EmulatorException("Trace file is truncated");
+        contents.assign(_trace.begin() + (long)_position, _trace.begin() + (long)(_position + size));
+        _position += size;
+    }
+
+    // Unchanged blocks are still applied again, since other blocks overlapping them may have been applied since then
+    size_t copied_size = std::min<size_t>(contents.size(), _ram.size() - address);
+    std::memcpy(_ram.data() + address, contents.data(), copied_size);
+}
+
+uint32_t ReplayEmulatorInterface::next_value(uint8_t size) const
+{
+    if(_position + size > _trace.size())
+        throw EmulatorException("Trace file is truncated");
+
+    uint32_t value = 0;
+    for(uint8_t i=0 ; i<size ; ++i)
+        value |= static_cast<uint32_t>(_trace[_position + i]) << (i * 8);
+    _position += size;
+    return value;
+}
+
+uint32_t ReplayEmulatorInterface::next_timestamp() const
+{
+    if(_position + RECORD_HEADER_SIZE > _trace.size())
+        throw EmulatorException("Trace file is truncated");
+
+    uint32_t timestamp = 0;
+    for(uint8_t i=0 ; i<4 ; ++i)
+        timestamp |= static_cast<uint32_t>(_trace[_position + 1 + i]) << (i * 8);
+    return timestamp;
+}
+
+void ReplayEmulatorInterface::set_ram_value(uint16_t address, uint32_t value, uint8_t size) const
+{
+    // RAM copy is stored in game order (big-endian)
+    for(uint8_t i=0 ; i<size && address + i < _ram.size() ; ++i)
+        _ram[address + i] = static_cast<uint8_t>(value >> ((size - 1 - i) * 8));
+}
+
+uint32_t ReplayEmulatorInterface::ram_value(uint16_t address, uint8_t size) const
+{
+    uint32_t value = 0;
+    for(uint8_t i=0 ; i<size && address + i < _ram.size() ; ++i)
+        value = (value << 8) | _ram[address + i];
+    return value;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include "emulator_interface.hpp"
+#include "emulator_trace.hpp"
+
+/**
+ * Fake emulator playing back a trace recorded by RecordingEmulatorInterface, which allows running the whole
+ * polling pipeline without any emulator process.
+ *
+ * Game RAM is modeled as a local copy which is updated by the values read during the recorded session. Values
+ * written by the client are applied to this copy, until a later recorded read overrides them. In real-time mode,
+ * records are applied following their timestamps. Otherwise, each read consumes the trace up to the next recorded
+ * read, which plays the session back as fast as it is polled.
+ */
+class ReplayEmulatorInterface : public EmulatorInterface
+{
+private:
+    std::vector<uint8_t> _trace;
+    mutable size_t _position = 0;
+    bool _real_time;
+    std::chrono::steady_clock::time_point _start_time;
+
+    mutable std::array<uint8_t, 0x10000> _ram {};
+    mutable std::map<uint32_t, std::vector<uint8_t>> _last_blocks;
+
+public:
+    ReplayEmulatorInterface(const std::string& path, bool real_time);
+    ~ReplayEmulatorInterface() override = default;
+
+    [[nodiscard]] uint8_t read_game_byte(uint16_t address) const override;
+    [[nodiscard]] uint16_t read_game_word(uint16_t address) const override;
+    [[nodiscard]] uint32_t read_game_long(uint16_t address) const override;
+    void read_game_block(uint16_t address, uint16_t size, uint8_t* output) const override;
+    void read_snapshot(GameRamSnapshot& snapshot) const override;
+
+    void write_game_byte(uint16_t address, uint8_t value) override;
+    void write_game_word(uint16_t address, uint16_t value) override;
+    void write_game_long(uint16_t address, uint32_t value) override;
+
+private:
+    /// Apply records from the trace depending on the replay mode, throwing once the whole trace was played back
+    void advance() const;
+    /// Apply the next record to the RAM copy, and return true if it was a read
+    bool apply_next_record() const;
+    void apply_block() const;
+    [[nodiscard]] uint32_t next_value(uint8_t size) const;
+    [[nodiscard]] uint32_t next_timestamp() const;
+
+    void set_ram_value(uint16_t address, uint32_t value, uint8_t size) const;
+    [[nodiscard]] uint32_t ram_value(uint16_t address, uint8_t size) const;
+};
@@ -0,0 +1,291 @@
+#include "retroarch_linux_mem_interface.hpp"
+
+#include <sys/uio.h>
+#include <elf.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include "game_ram_snapshot.hpp"
+#include "../logger.hpp"
+
+RetroarchLinuxMemInterface::RetroarchLinuxMemInterface()
+{
+    _process_id = find_process_id("retroarch");
+    if(_process_id == -1)
+        throw EmulatorException("Could not find a Retroarch process currently running.");
+
+    if(!read_module_information("genesis_plus_gx_libretro.so"))
+        throw EmulatorException("Could not find Genesis Plus GX core running.");
+
+    Logger::debug("Hooked on Genesis Plus GX core.");
+
+    for(const MemoryRange& range : _module_code_ranges)
+    {
+        std::ostringstream oss;
+        oss << "[0x" << std::hex << range.base << " - 0x" << (range.base + range.size) << "]";
+        Logger::debug(oss.str());
+    }
+
+    ProcessMemoryReader read = [this](uint64_t address, void* output, size_t size) -> bool {
+        return this->read_memory(address, output, size);
+    };
+
+    _game_ram_base_address = this->find_ram_base_addr_from_exports();
+    if(_game_ram_base_address == UINT64_MAX)
+        _game_ram_base_address = find_gpgx_ram_base_addr(_module_path, _module_code_ranges, read);
+    if(_game_ram_base_address == UINT64_MAX)
+    {
+        throw EmulatorException("Could not find any known signature on this core version.\n"
+                                "Please notify the author with your version of Retroarch & Genesis Plus GX.");
+    }
+
+    std::ostringstream oss2;
+    oss2 << "Game RAM = 0x" << std::hex << _game_ram_base_address;
+    Logger::debug(oss2.str());
+}
+
+uint8_t RetroarchLinuxMemInterface::read_game_byte(uint16_t address) const
+{
+    uint16_t even_address = address - (address % 2);
+    uint16_t word = this->read_game_word(even_address);
+    if(even_address == address)
+        return static_cast<uint8_t>(word >> 8);
+    return static_cast<uint8_t>(word);
+}
+
+uint16_t RetroarchLinuxMemInterface::read_game_word(uint16_t address) const
+{
+    uint16_t buffer = 0;
+    if(!this->read_memory(_game_ram_base_address + address, &buffer, sizeof(uint16_t)))
+        throw EmulatorException("Failed to read data from the emulator's memory");
+    return buffer;
+}
+
+uint32_t RetroarchLinuxMemInterface::read_game_long(uint16_t address) const
+{
+    uint32_t msw = this->read_game_word(address);
+    uint32_t lsw = this->read_game_word(address + 2);
+    return (msw << 16) + lsw;
+}
+
+void RetroarchLinuxMemInterface::read_game_block(uint16_t address, uint16_t size, uint8_t* output) const
+{
+    if(address % 2 != 0 || size % 2 != 0)
+        throw EmulatorException("Block reads from the emulator's memory must be word-aligned");
+
+    if(!this->read_memory(_game_ram_base_address + address, output, size))
+        throw EmulatorException("Failed to read data from the emulator's memory");
+
+    // RAM is stored as a sequence of native 16-bit words, swap bytes inside each word to get them in game order
+    for(uint16_t i=0 ; i<size ; i += 2)
+        std::swap(output[i], output[i+1]);
+}
+
+void RetroarchLinuxMemInterface::read_snapshot(GameRamSnapshot& snapshot) const
+{
+    // Read all blocks using a single vectored system call
+    std::vector<iovec> local_blocks;
+    std::vector<iovec> remote_blocks;
+    size_t total_size = 0;
+    for(const GameRamSnapshot::Block& block : snapshot.blocks())
+    {
+        local_blocks.emplace_back(iovec { snapshot.block_data(block), block.size });
+        remote_blocks.emplace_back(iovec { reinterpret_cast<void*>(_game_ram_base_address + block.address), block.size });
+        total_size += block.size;
+    }
+
+    ssize_t bytes_read = process_vm_readv(_process_id, local_blocks.data(), local_blocks.size(),
+                                          remote_blocks.data(), remote_blocks.size(), 0);
+    if(bytes_read < 0 || (size_t)bytes_read != total_size)
+        throw EmulatorException("Failed to read data from the emulator's memory");
+
+    for(const GameRamSnapshot::Block& block : snapshot.blocks())
+    {
+        uint8_t* data = snapshot.block_data(block);
+        for(uint16_t i=0 ; i<block.size ; i += 2)
+            std::swap(data[i], data[i+1]);
+    }
+}
+
+void RetroarchLinuxMemInterface::write_game_byte(uint16_t address, uint8_t value)
+{
+    uint16_t even_address = address - (address % 2);
+    if(address == even_address)
+        address += 1;
+    else
+        address -= 1;
+
+    this->write_memory(_game_ram_base_address + address, &value, sizeof(value));
+}
+
+void RetroarchLinuxMemInterface::write_game_word(uint16_t address, uint16_t value)
+{
+    this->write_memory(_game_ram_base_address + address, &value, sizeof(value));
+}
+
+void RetroarchLinuxMemInterface::write_game_long(uint16_t address, uint32_t value)
+{
+    uint16_t msw = value >> 16;
+    uint16_t lsw = static_cast<uint16_t>(value);
+    this->write_game_word(address, msw);
+    this->write_game_word(address + 2, lsw);
+}
+
+bool RetroarchLinuxMemInterface::read_memory(uint64_t address, void* output, size_t size) const
+{
+    iovec local = { output, size };
+    iovec remote = { reinterpret_cast<void*>(address), size };
+    ssize_t bytes_read = process_vm_readv(_process_id, &local, 1, &remote, 1, 0);
+    if(bytes_read < 0 && errno == EPERM)
+        throw EmulatorException("Not allowed to access Retroarch's memory. Please run the client as the same user as "
+                                "Retroarch, and check that /proc/sys/kernel/yama/ptrace_scope is set to 0.");
+    return bytes_read >= 0 && (size_t)bytes_read == size;
+}
+
+void RetroarchLinuxMemInterface::write_memory(uint64_t address, const void* input, size_t size)
+{
+    iovec local = { const_cast<void*>(input), size };
+    iovec remote = { reinterpret_cast<void*>(address), size };
+    ssize_t written_count = process_vm_writev(_process_id, &local, 1, &remote, 1, 0);
+    if(written_count < 0 || (size_t)written_count != size)
+        throw EmulatorException("Failed to write data into the emulator's memory");
+}
+
+pid_t RetroarchLinuxMemInterface::find_process_id(const std::string& process_name)
+{
+    std::error_code error;
+    for(const auto& entry : std::filesystem::directory_iterator("/proc", error))
+    {
+        const std::string pid_str = entry.path().filename().string();
+        if(pid_str.empty() || !std::all_of(pid_str.begin(), pid_str.end(), ::isdigit))
+            continue;
+
+        std::ifstream comm_file(entry.path() / "comm");
+        std::string comm;
+        if(comm_file && std::getline(comm_file, comm) && comm == process_name)
+            return static_cast<pid_t>(std::stoi(pid_str));
+    }
+
+    return -1;
+}
+
+bool RetroarchLinuxMemInterface::read_module_information(const std::string& module_name)
+{
+    std::ifstream maps_file("/proc/" + std::to_string(_process_id) + "/maps");
+    if(!maps_file)
+        return false;
+
+    // Each line looks like "7f12a4000000-7f12a4100000 r-xp 00000000 08:01 1234    /path/to/module.so"
+    std::string line;
+    while(std::getline(maps_file, line))
+    {
+        std::istringstream line_stream(line);
+        std::string address_range, permissions, offset, device, inode;
+        line_stream >> address_range >> permissions >> offset >> device >> inode;
+
+        std::string path;
+        std::getline(line_stream >> std::ws, path);
+        if(path != module_name && !path.ends_with("/" + module_name))
+            continue;
+
+        size_t dash_pos = address_range.find('-');
+        uint64_t start = std::stoull(address_range.substr(0, dash_pos), nullptr, 16);
+        uint64_t end = std::stoull(address_range.substr(dash_pos + 1), nullptr, 16);
+        if(std::stoull(offset, nullptr, 16) == 0)
+            _module_load_address = std::min(_module_load_address, start);
+
+        // Only executable parts of the module can contain the signatures we are looking for
+        if(permissions.size() < 3 || permissions[0] != 'r' || permissions[2] != 'x')
+            continue;
+
+        _module_code_ranges.emplace_back(MemoryRange { .base = start, .size = end - start });
+        _module_path = path;
+    }
+
+    return !_module_code_ranges.empty();
+}
+
+/**
+ * Look for a function in the dynamic symbol table of a 64-bit ELF shared object.
+ * @return the position of the function relative to the start of the file mapping, and its size (zero if not found)
+ */
+static MemoryRange find_exported_function(const std::string& module_path, const std::string& function_name)
+{
+    std::ifstream file(module_path, std::ios::binary);
+    auto read_at = [&file](uint64_t offset, void* output, size_t size) -> bool {
+        file.seekg(static_cast<std::streamoff>(offset));
+        return static_cast<bool>(file.read(static_cast<char*>(output), static_cast<std::streamsize>(size)));
+    };
+
+    Elf64_Ehdr header {};
+    if(!read_at(0, &header, sizeof(header)) || std::memcmp(header.e_ident, ELFMAG, SELFMAG) != 0
+    || header.e_ident[EI_CLASS] != ELFCLASS64 || header.e_shentsize != sizeof(Elf64_Shdr))
+        return { 0, 0 };
+
+    // Symbol values are virtual addresses, which are shifted from file positions by the first loaded segment
+    uint64_t load_vaddr = UINT64_MAX;
+    for(uint16_t i=0 ; i<header.e_phnum ; ++i)
+    {
+        Elf64_Phdr segment {};
+        if(!read_at(header.e_phoff + i * sizeof(Elf64_Phdr), &segment, sizeof(segment)))
+            return { 0, 0 };
+        if(segment.p_type == PT_LOAD && segment.p_offset == 0)
+            load_vaddr = segment.p_vaddr;
+    }
+    if(load_vaddr == UINT64_MAX)
+        return { 0, 0 };
+
+    std::vector<Elf64_Shdr> sections(header.e_shnum);
+    if(!read_at(header.e_shoff, sections.data(), sections.size() * sizeof(Elf64_Shdr)))
+        return { 0, 0 };
+
+    for(const Elf64_Shdr& symbol_table : sections)
+    {
+        if(symbol_table.sh_type != SHT_DYNSYM || symbol_table.sh_link >= sections.size())
+            continue;
+
+        const Elf64_Shdr& string_table = sections[symbol_table.sh_link];
+        std::vector<char> names(string_table.sh_size + 1, '\0');
+        std::vector<Elf64_Sym> symbols(symbol_table.sh_size / sizeof(Elf64_Sym));
+        if(!read_at(string_table.sh_offset, names.data(), string_table.sh_size)
+        || !read_at(symbol_table.sh_offset, symbols.data(), symbols.size() * sizeof(Elf64_Sym)))
+            return { 0, 0 };
+
+        for(const Elf64_Sym& symbol : symbols)
+        {
+            if(ELF64_ST_TYPE(symbol.st_info) != STT_FUNC || symbol.st_shndx == SHN_UNDEF
+            || symbol.st_name >= string_table.sh_size)
+                continue;
+            if(function_name == &names[symbol.st_name])
+                return { symbol.st_value - load_vaddr, symbol.st_size };
+        }
+    }
+
+    return { 0, 0 };
+}
+
+/**
+ * Find the RAM address inside the code of `retro_get_memory_data`, which is exported by every libretro core. This is
+ * much faster than scanning the whole module, and doesn't depend on the surrounding code generated by the compiler.
+ */
+uint64_t RetroarchLinuxMemInterface::find_ram_base_addr_from_exports() const
+{
+    if(_module_load_address == UINT64_MAX)
+        return UINT64_MAX;
+
+    MemoryRange function = find_exported_function(_module_path, "retro_get_memory_data");
+    if(function.size == 0)
+    {
+        Logger::debug("Could not find retro_get_memory_data in the symbols of " + _module_path);
+        return UINT64_MAX;
+    }
+    function.base += _module_load_address;
+
+    ProcessMemoryReader read = [this](uint64_t address, void* output, size_t size) -> bool {
+        return this->read_memory(address, output, size);
+    };
+    return find_gpgx_ram_base_addr_in_function(function, read);
+}
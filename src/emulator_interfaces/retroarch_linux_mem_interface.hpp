@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <sys/types.h>
+#include "emulator_interface.hpp"
+#include "gpgx_signatures.hpp"
+
+/**
+ * Linux counterpart of RetroarchMemInterface, attaching to a running "retroarch" process through /proc and
+ * accessing its memory using process_vm_readv / process_vm_writev.
+ *
+ * Not part of the client target yet, since the rest of the client (file dialogs, randstalker invocation) doesn't
+ * build on Linux.
+ */
+class RetroarchLinuxMemInterface : public EmulatorInterface
+{
+private:
+    pid_t _process_id = -1;
+    std::vector<MemoryRange> _module_code_ranges;
+    std::string _module_path;
+    /// Address where the start of the module file is mapped
+    uint64_t _module_load_address = UINT64_MAX;
+    uint64_t _game_ram_base_address = UINT64_MAX;
+
+public:
+    RetroarchLinuxMemInterface();
+    ~RetroarchLinuxMemInterface() override = default;
+
+    [[nodiscard]] uint8_t read_game_byte(uint16_t address) const override;
+    [[nodiscard]] uint16_t read_game_word(uint16_t address) const override;
+    [[nodiscard]] uint32_t read_game_long(uint16_t address) const override;
+    void read_game_block(uint16_t address, uint16_t size, uint8_t* output) const override;
+    void read_snapshot(GameRamSnapshot& snapshot) const override;
+
+    void write_game_byte(uint16_t address, uint8_t value) override;
+    void write_game_word(uint16_t address, uint16_t value) override;
+    void write_game_long(uint16_t address, uint32_t value) override;
+
+private:
+    [[nodiscard]] bool read_memory(uint64_t address, void* output, size_t size) const;
+    void write_memory(uint64_t address, const void* input, size_t size);
+    bool read_module_information(const std::string& module_name);
+    [[nodiscard]] uint64_t find_ram_base_addr_from_exports() const;
+
+    static pid_t find_process_id(const std::string& process_name);
+};
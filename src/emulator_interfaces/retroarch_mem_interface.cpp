@@ -5,6 +5,8 @@
 #include <utility>
 #include <iostream>
 #include <sstream>
+#include "game_ram_snapshot.hpp"
+#include "gpgx_signatures.hpp"
 #include "../logger.hpp"
 
 RetroarchMemInterface::RetroarchMemInterface()
@@ -74,6 +76,28 @@ uint32_t RetroarchMemInterface::read_game_long(uint16_t address) const
     return (msw << 16) + lsw;
 }
 
+void RetroarchMemInterface::read_game_block(uint16_t address, uint16_t size, uint8_t* output) const
+{
+    if(address % 2 != 0 || size % 2 != 0)
+        throw EmulatorException("Block reads from the emulator's memory must be word-aligned");
+
+    SIZE_T bytes_read;
+    LPCVOID addr = reinterpret_cast<LPCVOID>(_game_ram_base_address + address);
+    BOOL success = ReadProcessMemory(_process_handle, addr, output, size, &bytes_read);
+    if (!success || bytes_read != size)
+        throw EmulatorException("Failed to read data from the emulator's memory");
+
+    // RAM is stored as a sequence of native 16-bit words, swap bytes inside each word to get them in game order
+    for(uint16_t i=0 ; i<size ; i += 2)
+        std::swap(output[i], output[i+1]);
+}
+
+void RetroarchMemInterface::read_snapshot(GameRamSnapshot& snapshot) const
+{
+    for(const GameRamSnapshot::Block& block : snapshot.blocks())
+        this->read_game_block(block.address, block.size, snapshot.block_data(block));
+}
+
 void RetroarchMemInterface::write_game_byte(uint16_t address, uint8_t value)
 {
     uint16_t even_address = address - (address % 2);
@@ -186,6 +210,11 @@ bool RetroarchMemInterface::read_module_information(HANDLE processHandle, const
                     GetModuleInformation(processHandle, modules[i], &module_info, sizeof(MODULEINFO));
                     _base_address = reinterpret_cast<uint64_t>(module_base_address);
                     _module_size = module_info.SizeOfImage;
+
+                    char module_path[MAX_PATH];
+                    if(GetModuleFileNameEx(processHandle, modules[i], module_path, sizeof(module_path)))
+                        _module_path = module_path;
+
                     found = true;
                     break;
                 }
@@ -232,100 +261,13 @@ void RetroarchMemInterface::write_byte(uint64_t address, char value)
         throw EmulatorException("Failed to write data into the emulator's memory");
 }
 
-uint64_t RetroarchMemInterface::find_signature(const std::vector<uint16_t>& signature)
-{
-    BYTE* data = new BYTE[_module_size];
-    SIZE_T bytes_read;
-
-    ReadProcessMemory(_process_handle, reinterpret_cast<LPVOID>(_base_address), data, _module_size, &bytes_read);
-
-    for (DWORD i = 0; i < _module_size; i++)
-    {
-        // If we reached a point where the full signature cannot fit, we won't find a match so break out of this loop
-        if(i+signature.size() >= _module_size)
-            break;
-
-        bool signature_match = true;
-        for (DWORD j = 0; j < signature.size() ; ++j)
-        {
-            // 0xFFFF represents "any value", so don't bother comparing
-            if(signature[j] == 0xFFFF)
-                continue;
-
-            // If any of the bytes don't match with the signature, signature was not recognized so we can just
-            // stop trying
-            if(data[i+j] != signature[j])
-            {
-                signature_match = false;
-                break;
-            }
-        }
-
-        if(signature_match)
-        {
-            delete[] data;
-            return _base_address + i;
-        }
-    }
-
-    delete[] data;
-    return UINT64_MAX;
-}
-
 uint64_t RetroarchMemInterface::find_gpgx_ram_base_addr()
 {
-    constexpr uint16_t ANY = 0xFFFF;
-
-    // Signature 1 (RA 1.9.0 - GPGX 1.7.4 [7fa34f2] - 64 bit)
-    uint64_t addr = this->find_signature({
-        0x85, 0xC9, 0x74, ANY, 0x83, 0xF9, 0x02, 0xB8, 0x00, 0x00, 0x00, 0x00, 0x48, 0x0F, 0x44, 0x05,
-        ANY, ANY, ANY, ANY, 0xC3
-    });
-    if(addr != UINT64_MAX)
-    {
-        addr += 16;
-        Logger::debug("Found GPGX signature 1");
-        uint32_t offset = this->read_uint32(addr);
-        return this->read_uint64(addr + 4 + offset);
-    }
-
-    // Signature 2 (RA 1.13.0 - GPGX 1.7.4 [7907766] - 64 bit)
-    addr = this->find_signature({
-        0x85, 0xC9, 0x74, ANY, 0x31, 0xC0, 0x83, 0xF9, 0x02, 0x48, 0x0F, 0x44, 0x05,
-        ANY, ANY, ANY, ANY, 0xC3
-    });
-    if(addr != UINT64_MAX)
-    {
-        addr += 13;
-        Logger::debug("Found GPGX signature 2");
-        uint32_t offset = this->read_uint32(addr);
-        return this->read_uint64(addr + 4 + offset);
-    }
-
-    // Signature 3 (RA 1.15.0 - GPGX 1.7.4 [9745432] - 32 bit)
-    addr = this->find_signature({
-        0x8B, 0x54, 0x24, 0x04, 0x85, 0xD2, 0x74, ANY, 0x83, 0xFA, 0x02, 0xB8, ANY, ANY, ANY, ANY, 0xBA,
-        0x00, 0x00, 0x00, 0x00
-    });
-    if(addr != UINT64_MAX)
-    {
-        addr += 12;
-        Logger::debug("Found GPGX signature 3");
-        return this->read_uint32(addr);
-    }
-
-    // Signature 4 (???)
-    addr = this->find_signature({
-        0x8B, 0x44, 0x24, 0x04, 0x85, 0xC0, 0x74, 0x18, 0x83, 0xF8, 0x02, 0xBA, 0x00, 0x00, 0x00, 0x00, 0xB8,
-        ANY, ANY, ANY, ANY, 0x0F, 0x45, 0xC2, 0xC3, 0x8D, 0xB4, 0x26, 0x00, 0x00, 0x00, 0x00
-    });
-    if(addr != UINT64_MAX)
-    {
-        addr += 17;
-        Logger::debug("Found GPGX signature 4");
-        uint32_t offset = this->read_uint32(addr);
-        return this->read_uint32(addr + 4 + offset);
-    }
+    ProcessMemoryReader read = [this](uint64_t address, void* output, size_t size) -> bool {
+        SIZE_T bytes_read;
+        BOOL success = ReadProcessMemory(_process_handle, reinterpret_cast<LPCVOID>(address), output, size, &bytes_read);
+        return success && bytes_read == size;
+    };
 
-    return UINT64_MAX;
+    return ::find_gpgx_ram_base_addr(_module_path, { MemoryRange { .base = _base_address, .size = _module_size } }, read);
 }
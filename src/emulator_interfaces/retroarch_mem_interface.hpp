@@ -12,6 +12,7 @@ private:
     HANDLE _process_handle = nullptr;
     uint64_t _base_address = UINT64_MAX;
     uint64_t _module_size = UINT64_MAX;
+    std::string _module_path;
     uint64_t _game_ram_base_address = UINT64_MAX;
 
 public:
@@ -21,6 +22,8 @@ public:
     [[nodiscard]] uint8_t read_game_byte(uint16_t address) const override;
     [[nodiscard]] uint16_t read_game_word(uint16_t address) const override;
     [[nodiscard]] uint32_t read_game_long(uint16_t address) const override;
+    void read_game_block(uint16_t address, uint16_t size, uint8_t* output) const override;
+    void read_snapshot(GameRamSnapshot& snapshot) const override;
 
     void write_game_byte(uint16_t address, uint8_t value) override;
     void write_game_word(uint16_t address, uint16_t value) override;
@@ -30,7 +33,6 @@ private:
     uint32_t read_uint32(uint64_t address);
     uint64_t read_uint64(uint64_t address);
     void write_byte(uint64_t address, char value);
-    uint64_t find_signature(const std::vector<uint16_t>& signature);
     bool read_module_information(HANDLE processHandle, const std::string& module_name);
     uint64_t find_gpgx_ram_base_addr();
 
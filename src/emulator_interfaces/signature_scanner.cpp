@@ -0,0 +1,144 @@
+#include "signature_scanner.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SIGNATURE_SCANNER_USE_SSE2
+    #include <emmintrin.h>
+#endif
+
+/// Number of candidate positions tested together by the anchor filter
+constexpr size_t BLOCK_SIZE = 16;
+
+size_t SignatureScanner::add_pattern(const std::vector<uint16_t>& bytes)
+{
+    Pattern pattern;
+    pattern.bytes = bytes;
+
+    // Use the first and last fixed bytes of the pattern as anchors: being far apart, they are unlikely to be
+    // matched together by chance
+    auto first_fixed = std::find_if(bytes.begin(), bytes.end(), [](uint16_t b) { return b != ANY_BYTE; });
+    auto last_fixed = std::find_if(bytes.rbegin(), bytes.rend(), [](uint16_t b) { return b != ANY_BYTE; });
+    if(first_fixed != bytes.end())
+    {
+        pattern.first_anchor_pos = static_cast<uint16_t>(first_fixed - bytes.begin());
+        pattern.last_anchor_pos = static_cast<uint16_t>(bytes.size() - 1 - (last_fixed - bytes.rbegin()));
+    }
+
+    _max_pattern_size = std::max(_max_pattern_size, bytes.size());
+    _patterns.emplace_back(pattern);
+    return _patterns.size() - 1;
+}
+
+std::vector<uint64_t> SignatureScanner::scan(const std::vector<MemoryRange>& ranges,
+                                             const ProcessMemoryReader& read) const
+{
+    std::vector<uint64_t> results(_patterns.size(), UINT64_MAX);
+    if(_patterns.empty())
+        return results;
+
+    // Consecutive chunks overlap by the size of the biggest pattern, so that patterns crossing the boundary between
+    // two chunks are still found. Extra padding allows the anchor filter to read past the end of the chunk.
+    const size_t overlap = _max_pattern_size - 1;
+    std::vector<uint8_t> buffer(CHUNK_SIZE + overlap + _max_pattern_size + BLOCK_SIZE, 0x00);
+
+    for(const MemoryRange& range : ranges)
+    {
+        for(uint64_t offset = 0 ; offset < range.size ; offset += CHUNK_SIZE)
+        {
+            size_t start_count = std::min<uint64_t>(CHUNK_SIZE, range.size - offset);
+            size_t valid_size = std::min<uint64_t>(CHUNK_SIZE + overlap, range.size - offset);
+
+            // Chunks that cannot be read (e.g. unmapped pages inside the module) are skipped
+            if(!read(range.base + offset, buffer.data(), valid_size))
+                continue;
+            std::fill(buffer.begin() + (long)valid_size, buffer.end(), 0x00);
+
+            this->scan_chunk(buffer.data(), start_count, valid_size, range.base + offset, results);
+
+            if(std::find(results.begin(), results.end(), UINT64_MAX) == results.end())
+                return results;
+        }
+    }
+
+    return results;
+}
+
+bool SignatureScanner::matches(const Pattern& pattern, const uint8_t* data) const
+{
+    for(size_t i=0 ; i<pattern.bytes.size() ; ++i)
+        if(pattern.bytes[i] != ANY_BYTE && data[i] != pattern.bytes[i])
+            return false;
+    return true;
+}
+
+void SignatureScanner::scan_chunk(const uint8_t* data, size_t start_count, size_t valid_size, uint64_t chunk_address,
+                                  std::vector<uint64_t>& results) const
+{
+#ifdef SIGNATURE_SCANNER_USE_SSE2
+    for(size_t pos = 0 ; pos < start_count ; pos += BLOCK_SIZE)
+    {
+        __m128i candidates = _mm_setzero_si128();
+        for(const Pattern& pattern : _patterns)
+        {
+            __m128i first_anchor = _mm_set1_epi8((char)pattern.bytes[pattern.first_anchor_pos]);
+            __m128i last_anchor = _mm_set1_epi8((char)pattern.bytes[pattern.last_anchor_pos]);
+            __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + pattern.first_anchor_pos));
+            __m128i last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + pattern.last_anchor_pos));
+            __m128i match = _mm_and_si128(_mm_cmpeq_epi8(first, first_anchor), _mm_cmpeq_epi8(last, last_anchor));
+            candidates = _mm_or_si128(candidates, match);
+        }
+
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(candidates));
+        if(mask)
+            this->test_candidates(mask, data, pos, start_count, valid_size, chunk_address, results);
+    }
+#else
+    for(size_t pos = 0 ; pos < start_count ; pos += BLOCK_SIZE)
+    {
+        uint32_t mask = 0;
+        for(size_t bit = 0 ; bit < BLOCK_SIZE ; ++bit)
+        {
+            for(const Pattern& pattern : _patterns)
+            {
+                if(data[pos + bit + pattern.first_anchor_pos] == pattern.bytes[pattern.first_anchor_pos]
+                && data[pos + bit + pattern.last_anchor_pos] == pattern.bytes[pattern.last_anchor_pos])
+                {
+                    mask |= (1 << bit);
+                    break;
+                }
+            }
+        }
+
+        if(mask)
+            this->test_candidates(mask, data, pos, start_count, valid_size, chunk_address, results);
+    }
+#endif
+}
+
+void SignatureScanner::test_candidates(uint32_t candidates_mask, const uint8_t* data, size_t pos, size_t start_count,
+                                       size_t valid_size, uint64_t chunk_address, std::vector<uint64_t>& results) const
+{
+    for(size_t bit = 0 ; bit < BLOCK_SIZE ; ++bit)
+    {
+        if(!(candidates_mask & (1 << bit)))
+            continue;
+
+        size_t candidate_pos = pos + bit;
+        if(candidate_pos >= start_count)
+            return;
+
+        for(size_t i=0 ; i<_patterns.size() ; ++i)
+        {
+            // Only keep the first match for each pattern
+            if(results[i] != UINT64_MAX)
+                continue;
+
+            const Pattern& pattern = _patterns[i];
+            if(candidate_pos + pattern.bytes.size() > valid_size)
+                continue;
+            if(this->matches(pattern, data + candidate_pos))
+                results[i] = chunk_address + candidate_pos;
+        }
+    }
+}
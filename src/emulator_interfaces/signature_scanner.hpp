@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "gpgx_signatures.hpp"
+
+/**
+ * Finds several wildcard byte patterns inside the memory of another process in a single pass.
+ *
+ * Memory is streamed in fixed-size chunks instead of being copied all at once. Inside each chunk, candidates are
+ * filtered using two fixed bytes (anchors) of every pattern, tested 16 positions at a time using SSE2 when
+ * available. Only candidates matching the anchors of a pattern are then fully compared against it.
+ */
+class SignatureScanner
+{
+public:
+    static constexpr size_t CHUNK_SIZE = 0x10000;
+
+private:
+    struct Pattern
+    {
+        std::vector<uint16_t> bytes;
+        uint16_t first_anchor_pos = 0;
+        uint16_t last_anchor_pos = 0;
+    };
+
+    std::vector<Pattern> _patterns;
+    size_t _max_pattern_size = 0;
+
+public:
+    SignatureScanner() = default;
+
+    /// Register a pattern to look for (ANY_BYTE being a wildcard), and return its index
+    size_t add_pattern(const std::vector<uint16_t>& pattern);
+
+    /// Scan given memory ranges, and return the address of the first match of each pattern (UINT64_MAX if none)
+    [[nodiscard]] std::vector<uint64_t> scan(const std::vector<MemoryRange>& ranges,
+                                             const ProcessMemoryReader& read) const;
+
+private:
+    [[nodiscard]] bool matches(const Pattern& pattern, const uint8_t* data) const;
+    void scan_chunk(const uint8_t* data, size_t start_count, size_t valid_size, uint64_t chunk_address,
+                    std::vector<uint64_t>& results) const;
+    void test_candidates(uint32_t candidates_mask, const uint8_t* data, size_t pos, size_t start_count,
+                         size_t valid_size, uint64_t chunk_address, std::vector<uint64_t>& results) const;
+};
@@ -0,0 +1,79 @@
+#include "flag_watcher.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+/// Load 8 consecutive bytes as a word where byte N of the range is stored in bits [8N, 8N+8)
+static uint64_t load_word(const uint8_t* bytes)
+{
+    uint64_t word = 0;
+    if constexpr(std::endian::native == std::endian::little)
+    {
+        std::memcpy(&word, bytes, sizeof(word));
+    }
+    else
+    {
+        for(size_t i=0 ; i<sizeof(word) ; ++i)
+            word |= static_cast<uint64_t>(bytes[i]) << (i * 8);
+    }
+    return word;
+}
+
+FlagWatcher::FlagWatcher(const std::vector<WatchedFlag>& flags)
+{
+    if(flags.empty())
+        return;
+
+    auto [min_flag, max_flag] = std::minmax_element(flags.begin(), flags.end(), [](auto& a, auto& b) {
+        return a.byte < b.byte;
+    });
+
+    _start_address = min_flag->byte - (min_flag->byte % 8);
+    size_t word_count = ((max_flag->byte - _start_address) / 8) + 1;
+    _mask.resize(word_count, 0);
+    _previous_values.resize(word_count, 0);
+
+    // Count flags for each bit of the range, then turn those counts into offsets inside _flag_ids
+    const size_t bit_count = word_count * 64;
+    std::vector<uint16_t> bit_positions;
+    bit_positions.reserve(flags.size());
+    _flags_for_bit.resize(bit_count + 1, 0);
+    for(const WatchedFlag& flag : flags)
+    {
+        uint16_t bit_position = ((flag.byte - _start_address) * 8) + flag.bit;
+        bit_positions.emplace_back(bit_position);
+        _mask[bit_position / 64] |= (1ULL << (bit_position % 64));
+        _flags_for_bit[bit_position + 1]++;
+    }
+    for(size_t i=1 ; i<=bit_count ; ++i)
+        _flags_for_bit[i] += _flags_for_bit[i-1];
+
+    std::vector<uint16_t> fill_positions(_flags_for_bit.begin(), _flags_for_bit.end() - 1);
+    _flag_ids.resize(flags.size());
+    for(uint16_t flag_id=0 ; flag_id<flags.size() ; ++flag_id)
+        _flag_ids[fill_positions[bit_positions[flag_id]]++] = flag_id;
+}
+
+void FlagWatcher::reset()
+{
+    std::fill(_previous_values.begin(), _previous_values.end(), 0);
+}
+
+void FlagWatcher::update(const uint8_t* range_bytes, std::vector<uint16_t>& newly_set_flags)
+{
+    for(size_t i=0 ; i<_mask.size() ; ++i)
+    {
+        uint64_t value = load_word(range_bytes + (i * sizeof(uint64_t)));
+        uint64_t newly_set_bits = value & ~_previous_values[i] & _mask[i];
+        _previous_values[i] = value;
+
+        while(newly_set_bits)
+        {
+            size_t bit_position = (i * 64) + std::countr_zero(newly_set_bits);
+            for(uint16_t j = _flags_for_bit[bit_position] ; j < _flags_for_bit[bit_position+1] ; ++j)
+                newly_set_flags.emplace_back(_flag_ids[j]);
+            newly_set_bits &= newly_set_bits - 1;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Watches a set of flags (bits) inside a contiguous range of game RAM, and reports the ones that got set since
+ * the previous update.
+ *
+ * Watched flags are packed into dense 64-bit masks covering the whole range, which means detection is done a
+ * word at a time using `(new & ~old & mask)`, and only costs something for the words that actually changed.
+ */
+class FlagWatcher
+{
+public:
+    struct WatchedFlag
+    {
+        uint16_t byte;
+        uint8_t bit;
+    };
+
+private:
+    uint16_t _start_address = 0;
+    std::vector<uint64_t> _mask;
+    std::vector<uint64_t> _previous_values;
+
+    /// For each bit of the range, [_flags_for_bit[i], _flags_for_bit[i+1]) is the span of _flag_ids watching it
+    std::vector<uint16_t> _flags_for_bit;
+    std::vector<uint16_t> _flag_ids;
+
+public:
+    FlagWatcher() = default;
+    explicit FlagWatcher(const std::vector<WatchedFlag>& flags);
+
+    /// Address of the first byte of the watched range (always a multiple of 8)
+    [[nodiscard]] uint16_t start_address() const { return _start_address; }
+    /// Size in bytes of the watched range (always a multiple of 8)
+    [[nodiscard]] uint16_t size() const { return static_cast<uint16_t>(_mask.size() * sizeof(uint64_t)); }
+
+    /// Forget about previous values, making all flags currently set be reported again on next update
+    void reset();
+
+    /**
+     * Compare the current contents of the watched range with the ones from previous update, and append to
+     * `newly_set_flags` the index (in the array passed to the constructor) of all watched flags that got set.
+     * @param range_bytes the `size()` bytes of game RAM starting at `start_address()`, in game order
+     */
+    void update(const uint8_t* range_bytes, std::vector<uint16_t>& newly_set_flags);
+};
@@ -0,0 +1,234 @@
+#include "game_polling.hpp"
+
+#include <chrono>
+#include <vector>
+#include <landstalker_lib/constants/item_codes.hpp>
+#include "emulator_interfaces/game_ram_snapshot.hpp"
+#include "logger.hpp"
+
+std::map<uint16_t, PendingItemTimestamps> pending_item_timestamps;
+std::optional<LatencyStats::Clock::time_point> death_received_timestamp;
+
+constexpr uint16_t ADDR_RECEIVED_ITEM = 0x0020;                 // 1 byte long
+constexpr uint16_t ADDR_DEATHLINK_STATE = 0x0021;               // 1 byte long
+constexpr uint16_t ADDR_SEED = 0x0022;                          // 4 bytes long
+constexpr uint16_t ADDR_COMPLETION_BYTE = 0x0028;               // 1 byte long
+constexpr uint16_t ADDR_IS_IN_GAME = 0x1200;
+constexpr uint16_t ADDR_INVENTORY_START = 0x1040;               // 32 bytes long
+constexpr uint16_t ADDR_OWNED_ARMORS = 0x1044;
+constexpr uint16_t ADDR_CURRENT_RECEIVED_ITEM_INDEX = 0x107E;
+constexpr uint16_t ADDR_CURRENT_HEALTH = 0x543E;
+
+constexpr uint8_t INVENTORY_SIZE = 0x20;
+
+/// Delay between two item delivery polls while there are received items pending (around two frames)
+constexpr std::chrono::milliseconds ITEM_BURST_POLL_PERIOD(32);
+
+constexpr uint8_t DEATHLINK_STATE_IDLE = 0;
+constexpr uint8_t DEATHLINK_STATE_RECEIVED_DEATH = 1;
+constexpr uint8_t DEATHLINK_STATE_WAIT_FOR_RESURRECT = 2;
+
+constexpr uint8_t ITEM_PROGRESSIVE_ARMOR = 69; // 0x45
+constexpr uint8_t ITEM_ARCHIPELAGO_KAZALT_JEWEL = 70; // 0x46
+
+/**
+ * Read given snapshot from the emulator, along with the "is in game" flag. If no save file is currently loaded,
+ * there is nothing to do in-game, so scheduler is put in idle mode.
+ * @return true if a save file is currently loaded
+ */
+static bool read_game_ram(GameRamSnapshot& ram)
+{
+    ram.add_block(ADDR_IS_IN_GAME, 2);
+    emulator->read_snapshot(ram);
+
+    bool is_in_game = (ram.word(ADDR_IS_IN_GAME) != 0x00);
+    scheduler.idle(!is_in_game);
+    return is_in_game;
+}
+
+void check_seed()
+{
+    if(!multiworld || multiworld->is_offline_session())
+        return;
+
+    if(emulator->read_game_long(ADDR_SEED) != game_state.expected_seed())
+    {
+        delete emulator;
+        emulator = nullptr;
+        Logger::error("Invalid seed. Please ensure the right ROM was loaded.");
+    }
+}
+
+void poll_locations()
+{
+    FlagWatcher& flags_watcher = game_state.location_flags_watcher();
+
+    GameRamSnapshot ram;
+    ram.add_block(flags_watcher.start_address(), flags_watcher.size());
+    ram.add_block(ADDR_COMPLETION_BYTE, 2);
+    if(!read_game_ram(ram))
+        return;
+
+    // Only look at location flags that got set since last poll to find which locations were newly checked
+    std::vector<uint16_t> newly_set_flags;
+    flags_watcher.update(ram.bytes(flags_watcher.start_address(), flags_watcher.size()), newly_set_flags);
+
+    SessionEvent locations_event { .type = SessionEvent::Type::LOCATIONS_CHECKED };
+    for(uint16_t location_index : newly_set_flags)
+    {
+        Location& location = game_state.locations()[location_index];
+        if(location.was_checked())
+            continue;
+
+        location.was_checked(true);
+        locations_event.location_ids.emplace_back(location.id());
+    }
+
+    if(!locations_event.location_ids.empty())
+    {
+        game_state.publish_snapshot();
+        game_events.push(locations_event);
+        scheduler.wake(archipelago_task);
+    }
+
+    // Check goal completion
+    if(ram.byte(ADDR_COMPLETION_BYTE) == 0x01)
+    {
+        game_state.has_won(true);
+        emulator->write_game_byte(ADDR_COMPLETION_BYTE, 0x00);
+        game_events.push(SessionEvent { .type = SessionEvent::Type::GOAL_COMPLETED });
+        scheduler.wake(archipelago_task);
+    }
+}
+
+void poll_item_delivery()
+{
+    GameRamSnapshot ram;
+    ram.add_block(ADDR_RECEIVED_ITEM, 2); // Also contains ADDR_DEATHLINK_STATE
+    ram.add_block(ADDR_CURRENT_RECEIVED_ITEM_INDEX, 2);
+    ram.add_block(ADDR_OWNED_ARMORS, 2);
+    if(game_state.has_deathlink())
+        ram.add_block(ADDR_CURRENT_HEALTH, 2);
+    if(!read_game_ram(ram))
+        return;
+
+    // If there are received items that are not yet processed, send the next pending one to the player
+    uint16_t current_item_index_in_game = ram.word(ADDR_CURRENT_RECEIVED_ITEM_INDEX);
+
+    // Items below the in-game index were consumed by the game (or were already owned before connecting)
+    while(!pending_item_timestamps.empty() && pending_item_timestamps.begin()->first < current_item_index_in_game)
+    {
+        const PendingItemTimestamps& timestamps = pending_item_timestamps.begin()->second;
+        if(timestamps.written)
+        {
+            LatencyStats::get().record_since(LatencyStats::ITEM_WRITTEN_TO_CONSUMED, *timestamps.written);
+            LatencyStats::get().record_since(LatencyStats::ITEM_RECEIVED_TO_CONSUMED, timestamps.received);
+        }
+        pending_item_timestamps.erase(pending_item_timestamps.begin());
+    }
+
+    if(game_state.current_item_index() > current_item_index_in_game)
+    {
+        if(ram.byte(ADDR_RECEIVED_ITEM) == 0xFF)
+        {
+            uint8_t item_id = game_state.item_with_index(current_item_index_in_game);
+
+            // If the item is a progressive armor, look at the armors owned by the player and give them the next tier.
+            // Technically, we *could* send any kind of armor and the next tier would be received in-game, but the
+            // item name inside the "Got <ITEM>" textbox when an item is received directly depends on this ID.
+            if(item_id == ITEM_PROGRESSIVE_ARMOR)
+            {
+                uint32_t owned_armors = ram.word(ADDR_OWNED_ARMORS);
+                if((owned_armors & 0x2000) == 0)
+                    item_id = ITEM_STEEL_BREAST;
+                else if((owned_armors & 0x0002) == 0)
+                    item_id = ITEM_CHROME_BREAST;
+                else if((owned_armors & 0x0020) == 0)
+                    item_id = ITEM_SHELL_BREAST;
+                else
+                    item_id = ITEM_HYPER_BREAST;
+            }
+            else if(item_id == ITEM_ARCHIPELAGO_KAZALT_JEWEL)
+            {
+                // Kazalt Jewel over Archipelago is a fake item that needs to be converted into a Red Jewel on reception
+                item_id = ITEM_RED_JEWEL;
+            }
+
+            emulator->write_game_byte(ADDR_RECEIVED_ITEM, item_id);
+
+            auto it = pending_item_timestamps.find(current_item_index_in_game);
+            if(it != pending_item_timestamps.end() && !it->second.written)
+            {
+                it->second.written = LatencyStats::Clock::now();
+                LatencyStats::get().record_since(LatencyStats::ITEM_RECEIVED_TO_WRITTEN, it->second.received);
+            }
+        }
+
+        // While there are items waiting to be delivered, poll again as soon as the game might be ready to receive
+        // the next one, so that a big batch of items is delivered at the pace of the game instead of the pace of
+        // the regular polling
+        scheduler.wake(item_delivery_task, ITEM_BURST_POLL_PERIOD);
+    }
+
+    // Handle deathlink, both ways
+    if(game_state.has_deathlink())
+    {
+        uint8_t deathlink_state = ram.byte(ADDR_DEATHLINK_STATE);
+
+        // If another player died and we received the death notification, schedule a death
+        if(game_state.received_death() && deathlink_state == DEATHLINK_STATE_IDLE)
+        {
+            Logger::debug("Processing received death...");
+            emulator->write_game_byte(ADDR_DEATHLINK_STATE, DEATHLINK_STATE_RECEIVED_DEATH);
+            deathlink_state = DEATHLINK_STATE_RECEIVED_DEATH;
+            game_state.received_death(false);
+
+            if(death_received_timestamp)
+                LatencyStats::get().record_since(LatencyStats::DEATH_RECEIVED_TO_APPLIED, *death_received_timestamp);
+            death_received_timestamp.reset();
+        }
+
+        // If player just died, send a death notification to other players
+        if(ram.word(ADDR_CURRENT_HEALTH) == 0x0000)
+        {
+            // Check that this death wasn't caused by a recent received death or already processed
+            if(deathlink_state == DEATHLINK_STATE_IDLE)
+            {
+                Logger::debug("Player death detected");
+                emulator->write_game_byte(ADDR_DEATHLINK_STATE, DEATHLINK_STATE_WAIT_FOR_RESURRECT);
+                game_events.push(SessionEvent { .type = SessionEvent::Type::PLAYER_DIED });
+                scheduler.wake(archipelago_task);
+            }
+        }
+        else if(deathlink_state == DEATHLINK_STATE_WAIT_FOR_RESURRECT)
+        {
+            // Player has life and is in a "post deathlink" state, clear it back to normal to make
+            // dying from deathlink and sending deaths possible again
+            emulator->write_game_byte(ADDR_DEATHLINK_STATE, DEATHLINK_STATE_IDLE);
+        }
+    }
+}
+
+void poll_inventory()
+{
+    GameRamSnapshot ram;
+    ram.add_block(ADDR_INVENTORY_START, INVENTORY_SIZE);
+    if(!read_game_ram(ram))
+        return;
+
+    // Update inventory bytes for the item tracker
+    bool inventory_changed = false;
+    const uint8_t* inventory_bytes = ram.bytes(ADDR_INVENTORY_START, INVENTORY_SIZE);
+    for(uint8_t i=0 ; i<INVENTORY_SIZE ; ++i)
+    {
+        if(game_state.update_inventory_byte(i, inventory_bytes[i]))
+            inventory_changed = true;
+    }
+
+    // If any of the inventory values changed, let the UI update logic for the map tracker
+    if(inventory_changed)
+    {
+        game_state.publish_snapshot();
+        ui_events.push(SessionEvent { .type = SessionEvent::Type::INVENTORY_CHANGED });
+    }
+}
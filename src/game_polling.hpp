@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include "emulator_interfaces/emulator_interface.hpp"
+#include "multiworld_interfaces/multiworld_interface.hpp"
+#include "game_state.hpp"
+#include "latency_stats.hpp"
+#include "mpsc_queue.hpp"
+#include "poll_scheduler.hpp"
+#include "session_events.hpp"
+
+/**
+ * Tasks polling the game through the emulator, which are run by the poll scheduler with the session locked.
+ * They work on the globals below, which are defined by the program running them (the client itself, or
+ * tools/replay_benchmark).
+ */
+
+extern GameState game_state;
+extern MultiworldInterface* multiworld;
+extern EmulatorInterface* emulator;
+extern PollScheduler scheduler;
+extern PollScheduler::TaskId archipelago_task;
+extern PollScheduler::TaskId item_delivery_task;
+/// Events emitted by the game side, to be transmitted to the multiworld
+extern MpscQueue<SessionEvent> game_events;
+/// Events emitted by the game side, to be handled by the UI thread
+extern MpscQueue<SessionEvent> ui_events;
+
+/// Timestamps of received items which were not consumed by the game yet, indexed by received item index
+struct PendingItemTimestamps
+{
+    LatencyStats::Clock::time_point received;
+    std::optional<LatencyStats::Clock::time_point> written {};
+};
+extern std::map<uint16_t, PendingItemTimestamps> pending_item_timestamps;
+extern std::optional<LatencyStats::Clock::time_point> death_received_timestamp;
+
+void check_seed();
+void poll_locations();
+void poll_item_delivery();
+void poll_inventory();
@@ -1,23 +1,24 @@
 #include "game_state.hpp"
 
-#include <nlohmann/json.hpp>
 #include <fstream>
 #include <landstalker_lib/constants/item_codes.hpp>
-#include "data/item_source.json.hxx"
 #include "logger.hpp"
 
-using nlohmann::json;
-
 GameState::GameState()
 {
     _received_items.reserve(256);
 
-    json input_json = json::parse(ITEM_SOURCES_JSON);
-    for(json& location_data : input_json)
-        _locations.emplace_back(Location(location_data));
-    std::sort(_locations.begin(), _locations.end(), [](Location& loc1, Location& loc2){
-        return loc1.name() < loc2.name();
-    });
+    // Locations are stored by their index in the generated location index (alphabetical order)
+    _locations.reserve(location_count());
+    for(uint16_t i=0 ; i<location_count() ; ++i)
+        _locations.emplace_back(Location(i));
+
+    std::vector<FlagWatcher::WatchedFlag> location_flags;
+    for(const Location& location : _locations)
+        location_flags.emplace_back(FlagWatcher::WatchedFlag { location.checked_flag_byte(), location.checked_flag_bit() });
+    _location_flags_watcher = FlagWatcher(location_flags);
+
+    this->publish_snapshot();
 }
 
 void GameState::reset()
@@ -25,15 +26,15 @@ void GameState::reset()
     _built_rom_path = "";
 
     _received_items.clear();
-    _must_send_checked_locations = false;
     _expected_seed = 0xFFFFFFFF;
     _has_won = false;
     _has_deathlink = false;
     _received_death = false;
-    _must_send_death = false;
 
     for(Location& location : _locations)
         location.reset();
+    _location_flags_watcher.reset();
+    this->publish_snapshot();
 }
 
 uint8_t GameState::item_with_index(uint16_t received_item_index) const
@@ -55,12 +56,12 @@ void GameState::set_received_item(uint16_t index, uint8_t item)
     _received_items[index] = item;
 }
 
-Location* GameState::location(const std::string& name)
+Location* GameState::location(std::string_view name)
 {
-    for(Location& loc : _locations)
-        if(loc.name() == name)
-            return &loc;
-    return nullptr;
+    uint16_t index = location_index(name);
+    if(index == LOCATION_INDEX_NONE)
+        return nullptr;
+    return &_locations[index];
 }
 
 std::vector<int64_t> GameState::checked_locations() const
@@ -84,12 +85,12 @@ bool GameState::update_inventory_byte(uint8_t byte_id, uint8_t value)
     return true;
 }
 
-uint8_t GameState::owned_item_quantity(uint8_t item_id) const
+static uint8_t owned_item_quantity_in_inventory(const std::array<uint8_t, 0x20>& inventory_bytes, uint8_t item_id)
 {
     uint8_t byte = (item_id / 2);
     uint8_t upper_half_byte = (item_id % 2 == 1);
 
-    uint8_t byte_value = _inventory_bytes.at(byte);
+    uint8_t byte_value = inventory_bytes.at(byte);
 
     uint8_t quantity = (upper_half_byte) ? (byte_value >> 4) : (byte_value & 0x0F);
 
@@ -99,4 +100,25 @@ uint8_t GameState::owned_item_quantity(uint8_t item_id) const
         quantity -= 1;
 
     return quantity;
-}
\ No newline at end of file
+}
+
+uint8_t GameState::owned_item_quantity(uint8_t item_id) const
+{
+    return owned_item_quantity_in_inventory(_inventory_bytes, item_id);
+}
+
+void GameState::publish_snapshot()
+{
+    auto snapshot = std::make_shared<GameStateSnapshot>();
+    snapshot->inventory_bytes = _inventory_bytes;
+    for(const Location& loc : _locations)
+        if(loc.was_checked())
+            snapshot->checked_locations.insert(loc.id());
+
+    _snapshot.store(snapshot);
+}
+
+uint8_t GameStateSnapshot::owned_item_quantity(uint8_t item_id) const
+{
+    return owned_item_quantity_in_inventory(inventory_bytes, item_id);
+}
@@ -4,24 +4,42 @@
 #include <vector>
 #include <set>
 #include <iostream>
+#include <array>
+#include <atomic>
+#include <memory>
 #include "location.hpp"
+#include "flag_watcher.hpp"
+
+/**
+ * Immutable copy of the parts of GameState displayed by the UI. A new one is published by the game side every time
+ * one of those values changes, which means the UI never has to read the state being modified.
+ */
+struct GameStateSnapshot
+{
+    std::array<uint8_t, 0x20> inventory_bytes {};
+    std::set<uint16_t> checked_locations;
+
+    [[nodiscard]] bool was_checked(const Location& location) const { return checked_locations.contains(location.id()); }
+    [[nodiscard]] uint8_t owned_item_quantity(uint8_t item_id) const;
+};
 
 class GameState {
 private:
     std::string _built_rom_path;
 
     std::vector<Location> _locations;
+    FlagWatcher _location_flags_watcher;
 
     std::vector<uint8_t> _received_items;
-    bool _must_send_checked_locations = false;
     uint32_t _expected_seed = 0xFFFFFFFF;
     bool _has_won = false;
 
-    std::array<uint8_t, 0x20> _inventory_bytes;
+    std::array<uint8_t, 0x20> _inventory_bytes {};
 
     bool _has_deathlink = false;
     bool _received_death = false;
-    bool _must_send_death = false;
+
+    std::atomic<std::shared_ptr<const GameStateSnapshot>> _snapshot;
 
 public:
     GameState();
@@ -33,10 +51,10 @@ public:
 
     [[nodiscard]] const std::vector<Location>& locations() const { return _locations; }
     [[nodiscard]] std::vector<Location>& locations() { return _locations; }
-    [[nodiscard]] Location* location(const std::string& name);
+    [[nodiscard]] Location* location(std::string_view name);
+    /// Watcher over all location flags, reporting indices inside the locations() vector
+    [[nodiscard]] FlagWatcher& location_flags_watcher() { return _location_flags_watcher; }
 
-    [[nodiscard]] bool must_send_checked_locations() const { return _must_send_checked_locations; }
-    void must_send_checked_locations(bool val) { _must_send_checked_locations = val; }
     [[nodiscard]] std::vector<int64_t> checked_locations() const;
 
     [[nodiscard]] uint32_t expected_seed() const { return _expected_seed; }
@@ -51,13 +69,14 @@ public:
     [[nodiscard]] bool received_death() const { return _received_death; }
     void received_death(bool val) { _received_death = val; }
 
-    [[nodiscard]] bool must_send_death() const { return _must_send_death; }
-    void must_send_death(bool val) { _must_send_death = val; }
-
     [[nodiscard]] bool has_built_rom() const { return !_built_rom_path.empty(); }
     [[nodiscard]] const std::string& built_rom_path() const { return _built_rom_path; }
     void built_rom_path(const std::string& val) { _built_rom_path = val; }
 
     bool update_inventory_byte(uint8_t byte_id, uint8_t value);
     [[nodiscard]] uint8_t owned_item_quantity(uint8_t item_id) const;
+
+    /// Publish a new snapshot for the UI, to be called after inventory or checked locations changed
+    void publish_snapshot();
+    [[nodiscard]] std::shared_ptr<const GameStateSnapshot> snapshot() const { return _snapshot.load(); }
 };
@@ -0,0 +1,94 @@
+#include "latency_stats.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+void LatencyStats::record(Stage stage, Clock::duration duration)
+{
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    uint32_t sample = static_cast<uint32_t>(std::clamp<int64_t>(millis, 0, UINT32_MAX));
+
+    std::lock_guard lock(_mutex);
+    RollingWindow& window = _windows[stage];
+    if(window.samples.size() < WINDOW_SIZE)
+        window.samples.emplace_back(sample);
+    else
+        window.samples[window.next_sample] = sample;
+
+    window.next_sample = (window.next_sample + 1) % WINDOW_SIZE;
+    window.total_count += 1;
+}
+
+LatencyStats::Summary LatencyStats::summary(Stage stage)
+{
+    std::vector<uint32_t> samples;
+    Summary summary;
+    {
+        std::lock_guard lock(_mutex);
+        samples = _windows[stage].samples;
+        summary.total_count = _windows[stage].total_count;
+    }
+
+    summary.window_count = samples.size();
+    if(samples.empty())
+        return summary;
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](size_t percent) -> uint32_t {
+        size_t rank = (samples.size() * percent + 99) / 100;
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+    summary.p50 = percentile(50);
+    summary.p95 = percentile(95);
+    summary.p99 = percentile(99);
+    return summary;
+}
+
+bool LatencyStats::has_samples()
+{
+    std::lock_guard lock(_mutex);
+    return std::any_of(_windows.begin(), _windows.end(), [](const RollingWindow& w) { return w.total_count > 0; });
+}
+
+bool LatencyStats::export_to_file(const std::string& path)
+{
+    nlohmann::json json = nlohmann::json::object();
+    for(int i=0 ; i<STAGE_COUNT ; ++i)
+    {
+        Stage stage = static_cast<Stage>(i);
+        Summary stage_summary = this->summary(stage);
+        json[stage_name(stage)] = {
+            { "totalCount", stage_summary.total_count },
+            { "windowCount", stage_summary.window_count },
+            { "p50", stage_summary.p50 },
+            { "p95", stage_summary.p95 },
+            { "p99", stage_summary.p99 }
+        };
+    }
+
+    std::ofstream file(path);
+    if(!file)
+        return false;
+    file << json.dump(4);
+    return true;
+}
+
+const char* LatencyStats::stage_name(Stage stage)
+{
+    switch(stage)
+    {
+        case ITEM_RECEIVED_TO_WRITTEN:  return "itemReceivedToWritten";
+        case ITEM_WRITTEN_TO_CONSUMED:  return "itemWrittenToConsumed";
+        case ITEM_RECEIVED_TO_CONSUMED: return "itemReceivedToConsumed";
+        case LOCATION_CHECKED_TO_SENT:  return "locationCheckedToSent";
+        case DEATH_RECEIVED_TO_APPLIED: return "deathReceivedToApplied";
+        default:                        return "unknown";
+    }
+}
+
+LatencyStats& LatencyStats::get()
+{
+    static LatencyStats instance;
+    return instance;
+}
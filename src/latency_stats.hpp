@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Keeps track of how long each stage of the session pipeline takes (item delivery, location checks, deathlink),
+ * over a rolling window of the most recent samples for each stage.
+ */
+class LatencyStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Stage {
+        ITEM_RECEIVED_TO_WRITTEN = 0,   ///< Item received from server -> item written into game RAM
+        ITEM_WRITTEN_TO_CONSUMED,       ///< Item written into game RAM -> item consumed by the game
+        ITEM_RECEIVED_TO_CONSUMED,      ///< Item received from server -> item consumed by the game
+        LOCATION_CHECKED_TO_SENT,       ///< Location flag detected in game RAM -> location check sent to server
+        DEATH_RECEIVED_TO_APPLIED,      ///< Death received from server -> death triggered in game RAM
+        STAGE_COUNT
+    };
+
+    struct Summary {
+        uint64_t total_count = 0;
+        size_t window_count = 0;
+        uint32_t p50 = 0;
+        uint32_t p95 = 0;
+        uint32_t p99 = 0;
+    };
+
+    /// Number of most recent samples kept for each stage to compute percentiles
+    static constexpr size_t WINDOW_SIZE = 512;
+
+private:
+    struct RollingWindow {
+        std::vector<uint32_t> samples;
+        size_t next_sample = 0;
+        uint64_t total_count = 0;
+    };
+
+    std::array<RollingWindow, STAGE_COUNT> _windows;
+    std::mutex _mutex;
+
+public:
+    void record(Stage stage, Clock::duration duration);
+    void record_since(Stage stage, Clock::time_point start) { this->record(stage, Clock::now() - start); }
+
+    /// Percentiles (in milliseconds) computed over the samples currently inside the rolling window of given stage
+    [[nodiscard]] Summary summary(Stage stage);
+    [[nodiscard]] bool has_samples();
+
+    bool export_to_file(const std::string& path);
+
+    static const char* stage_name(Stage stage);
+    static LatencyStats& get();
+
+private:
+    LatencyStats() = default;
+};
@@ -1,29 +1,31 @@
 #pragma once
 
 #include <cstdint>
-#include <nlohmann/json.hpp>
+#include <string_view>
+#include "location_index.hpp"
 
 class Location {
 private:
     uint16_t _id = 0xFFFF;
-    std::string _name;
+    uint16_t _index = LOCATION_INDEX_NONE;
     uint16_t _checked_flag_byte = 0x0000;
     uint8_t _checked_flag_bit = 0x00;
     bool _was_checked = false;
     bool _reachable = false;
-    std::string _url;
 
 public:
     Location() = default;
-    explicit Location(nlohmann::json& location_data);
+    explicit Location(uint16_t index);
 
     void reset();
 
     [[nodiscard]] uint16_t id() const { return _id; }
-    [[nodiscard]] const std::string& name() const { return _name; }
+    /// Index of the location in the generated location index, which is also its index in `GameState::locations()`
+    [[nodiscard]] uint16_t index() const { return _index; }
+    [[nodiscard]] std::string_view name() const { return location_name(_index); }
     [[nodiscard]] uint16_t checked_flag_byte() const { return _checked_flag_byte; }
     [[nodiscard]] uint8_t checked_flag_bit() const { return _checked_flag_bit; }
-    [[nodiscard]] const std::string& url() const { return _url; }
+    [[nodiscard]] std::string_view url() const { return location_url(_index); }
 
     [[nodiscard]] bool was_checked() const { return _was_checked; }
     void was_checked(bool value) { _was_checked = value; }
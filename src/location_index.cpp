@@ -0,0 +1,39 @@
+#include "location_index.hpp"
+
+#include "location_name_hash.hpp"
+#include "data/location_index.hxx"
+
+uint16_t location_count()
+{
+    return LOCATION_COUNT;
+}
+
+uint16_t location_index(std::string_view name)
+{
+    uint32_t bucket = location_name_hash(name, 0) & (LOCATION_HASH_BUCKET_COUNT - 1);
+    uint32_t displacement = LOCATION_HASH_DISPLACEMENTS[bucket];
+    if(displacement == 0)
+        return LOCATION_INDEX_NONE;
+
+    uint16_t index = LOCATION_HASH_SLOTS[location_name_hash(name, displacement) & (LOCATION_HASH_SLOT_COUNT - 1)];
+
+    // Names that are not locations also land somewhere, check it really is the one we are looking for
+    if(index == LOCATION_INDEX_NONE || location_name(index) != name)
+        return LOCATION_INDEX_NONE;
+    return index;
+}
+
+std::string_view location_name(uint16_t index)
+{
+    return { LOCATION_STRING_POOL + LOCATION_NAME_OFFSETS[index] };
+}
+
+std::string_view location_url(uint16_t index)
+{
+    return { LOCATION_STRING_POOL + LOCATION_URL_OFFSETS[index] };
+}
+
+const LocationDefinition& location_definition(uint16_t index)
+{
+    return LOCATION_DEFINITIONS[index];
+}
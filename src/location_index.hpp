@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include "data_tables.hpp"
+
+/**
+ * Dense index of all locations, generated at build time from `item_source.json` (see tools/data_table_generator).
+ *
+ * Locations are identified by an index in [0, location_count()[ following the alphabetical order of their names,
+ * and their names and URLs are views inside a single read-only string pool. Views are NUL-terminated, so their
+ * data can directly be passed to C APIs.
+ */
+
+constexpr uint16_t LOCATION_INDEX_NONE = 0xFFFF;
+
+[[nodiscard]] uint16_t location_count();
+
+/// @return the index of the location with given name using a perfect hash, or LOCATION_INDEX_NONE if there is none
+[[nodiscard]] uint16_t location_index(std::string_view name);
+
+[[nodiscard]] std::string_view location_name(uint16_t index);
+[[nodiscard]] std::string_view location_url(uint16_t index);
+[[nodiscard]] const LocationDefinition& location_definition(uint16_t index);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Seeded 32-bit FNV-1a hash of a location name, shared by the location index generator (which looks for the seeds
+ * making the hash perfect over all location names) and the client (which uses the generated seeds to look names up).
+ */
+constexpr uint32_t location_name_hash(std::string_view name, uint32_t seed)
+{
+    uint32_t hash = 0x811c9dc5 ^ (seed * 0x9e3779b9);
+    for(char c : name)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x01000193;
+    }
+    return hash;
+}
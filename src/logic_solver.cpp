@@ -0,0 +1,194 @@
+#include "logic_solver.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include "location.hpp"
+#include "location_index.hpp"
+#include "randstalker_invoker.hpp"
+
+#define SOLVE_LOGIC_PRESET_FILE_PATH "./_solve_logic.json"
+
+LogicSolver::LogicSolver() :
+    _cache(location_count())
+{
+    _thread = std::thread(&LogicSolver::run, this);
+}
+
+LogicSolver::~LogicSolver()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stopped = true;
+    }
+    _condition.notify_one();
+    _thread.join();
+}
+
+void LogicSolver::request_solve(nlohmann::json preset, const std::vector<nlohmann::json>& speculative_presets)
+{
+    uint64_t key = ReachabilityCache::key(preset);
+    std::deque<std::pair<uint64_t, nlohmann::json>> speculations;
+    for(const nlohmann::json& speculative_preset : speculative_presets)
+        speculations.emplace_back(ReachabilityCache::key(speculative_preset), speculative_preset);
+
+    {
+        std::lock_guard lock(_mutex);
+        _generation += 1;
+        _speculative_presets = std::move(speculations);
+
+        std::optional<ReachabilityCache::Bitset> cached_result = _cache.find(key);
+        if(cached_result)
+        {
+            _pending_preset.reset();
+            _result = std::move(cached_result);
+            _condition.notify_one();
+            return;
+        }
+
+        _pending_preset = std::move(preset);
+        _pending_key = key;
+    }
+    _condition.notify_one();
+}
+
+void LogicSolver::cancel()
+{
+    std::lock_guard lock(_mutex);
+    _pending_preset.reset();
+    _speculative_presets.clear();
+    _result.reset();
+    _generation += 1;
+}
+
+void LogicSolver::pause_speculation(bool paused)
+{
+    {
+        std::lock_guard lock(_mutex);
+        _speculation_paused = paused;
+    }
+    _condition.notify_one();
+}
+
+bool LogicSolver::apply_result(std::vector<Location>& locations)
+{
+    std::optional<ReachabilityCache::Bitset> result;
+    {
+        std::lock_guard lock(_mutex);
+        if(!_result)
+            return false;
+        result.swap(_result);
+    }
+
+    for(size_t i=0 ; i<locations.size() && i<result->size() ; ++i)
+        locations[i].reachable((*result)[i]);
+    return true;
+}
+
+void LogicSolver::load_cache(const std::string& file_path)
+{
+    std::lock_guard lock(_mutex);
+    _cache.save_to_file();
+    _cache.file_path = file_path;
+    _cache.load_from_file();
+}
+
+void LogicSolver::save_cache()
+{
+    std::lock_guard lock(_mutex);
+    _cache.save_to_file();
+}
+
+void LogicSolver::run()
+{
+    std::unique_lock lock(_mutex);
+    Clock::time_point next_speculation = Clock::now();
+    while(true)
+    {
+        if(_stopped)
+            return;
+
+        if(_pending_preset)
+        {
+            nlohmann::json preset = std::move(*_pending_preset);
+            _pending_preset.reset();
+            uint64_t key = _pending_key;
+            uint64_t generation = _generation;
+
+            lock.unlock();
+            std::optional<ReachabilityCache::Bitset> result = this->solve(preset);
+            lock.lock();
+
+            // A failed solve is neither remembered nor applied, locations keep their previous reachability instead
+            if(!result)
+                continue;
+
+            // Even a superseded result is worth remembering, but applying it would show a state that is already gone
+            _cache.insert(key, *result);
+            if(generation == _generation)
+                _result = std::move(result);
+            continue;
+        }
+
+        if(_speculative_presets.empty() || _speculation_paused)
+        {
+            _condition.wait(lock);
+            continue;
+        }
+
+        // Stay idle long enough after each speculative solve to keep within the CPU budget
+        if(Clock::now() < next_speculation)
+        {
+            _condition.wait_until(lock, next_speculation);
+            continue;
+        }
+
+        auto [key, preset] = std::move(_speculative_presets.front());
+        _speculative_presets.pop_front();
+        if(_cache.contains(key))
+            continue;
+        uint64_t generation = _generation;
+
+        lock.unlock();
+        Clock::time_point start = Clock::now();
+        std::optional<ReachabilityCache::Bitset> result = this->solve(preset);
+        Clock::duration solve_duration = Clock::now() - start;
+        lock.lock();
+
+        // Remaining presets would most likely fail the same way, they are dropped unless a new request replaced them
+        if(result)
+            _cache.insert(key, std::move(*result));
+        else if(generation == _generation)
+            _speculative_presets.clear();
+
+        // Solve duration includes starting randstalker, so pacing also accounts for the cost of spawning it
+        next_speculation = Clock::now() + solve_duration * (100 - SPECULATION_CPU_BUDGET_PERCENT)
+                                                        / SPECULATION_CPU_BUDGET_PERCENT;
+    }
+}
+
+std::optional<ReachabilityCache::Bitset> LogicSolver::solve(const nlohmann::json& preset)
+{
+    std::ofstream preset_file(SOLVE_LOGIC_PRESET_FILE_PATH);
+    preset_file << preset.dump();
+    preset_file.close();
+
+    std::string command = "randstalker.exe";
+    command += " --preset=\"" SOLVE_LOGIC_PRESET_FILE_PATH "\"";
+    command += " --solvelogic";
+    std::optional<std::set<std::string>> reachable_locations = invoke_randstalker_to_solve_logic(command);
+
+#ifndef DEBUG
+    std::filesystem::remove(std::filesystem::path(SOLVE_LOGIC_PRESET_FILE_PATH));
+#endif
+    if(!reachable_locations)
+        return std::nullopt;
+
+    ReachabilityCache::Bitset result(location_count(), false);
+    for(const std::string& location_name : *reachable_locations)
+    {
+        uint16_t index = location_index(location_name);
+        if(index != LOCATION_INDEX_NONE)
+            result[index] = true;
+    }
+    return result;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "reachability_cache.hpp"
+
+class Location;
+
+/**
+ * Solves map tracker logic on a dedicated worker thread, so that neither the UI nor the poll loop ever wait for
+ * randstalker.
+ *
+ * Solving follows latest-wins semantics: a new request replaces the one waiting to be picked up by the worker, and
+ * the result of a solve that got superseded (or cancelled) while it was running is dropped. Results are kept until
+ * the owner of the locations applies them all at once using `apply_result()`.
+ *
+ * Results are memoized in a ReachabilityCache, so that going back to an already solved state (e.g. toggling a
+ * tracker setting back and forth) never involves the solver.
+ *
+ * When it has nothing else to do, the worker speculatively solves the states the player is likely to reach next
+ * (e.g. the current inventory plus any item that isn't owned yet) to fill the cache before they are requested.
+ * Speculative solving only uses a fraction of the worker's time, and can be paused while something heavier runs.
+ */
+class LogicSolver
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /// Share of the worker's time that can be spent on speculative solves
+    static constexpr uint32_t SPECULATION_CPU_BUDGET_PERCENT = 25;
+
+    ReachabilityCache _cache;
+
+    /// Preset of the latest request (and its cache key), until the worker picks it up
+    std::optional<nlohmann::json> _pending_preset;
+    uint64_t _pending_key = 0;
+    /// Incremented by each request and cancellation, used to recognize stale results
+    uint64_t _generation = 0;
+    /// Presets (and their cache keys) to solve speculatively, reset by each request
+    std::deque<std::pair<uint64_t, nlohmann::json>> _speculative_presets;
+    bool _speculation_paused = false;
+    /// Result of the latest request, until it gets applied
+    std::optional<ReachabilityCache::Bitset> _result;
+    bool _stopped = false;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::thread _thread;
+
+public:
+    LogicSolver();
+    ~LogicSolver();
+
+    LogicSolver(const LogicSolver&) = delete;
+    LogicSolver& operator=(const LogicSolver&) = delete;
+
+    /**
+     * Ask for a solve using given preset, superseding any previous request. Cached results are available right away.
+     * @param speculative_presets presets likely to be requested next, to be solved in advance when the worker is idle
+     */
+    void request_solve(nlohmann::json preset, const std::vector<nlohmann::json>& speculative_presets = {});
+
+    /// Drop any pending request, as well as the result of the solve currently running
+    void cancel();
+
+    /// Suspend speculative solving (e.g. while a ROM is being built), or resume it
+    void pause_speculation(bool paused);
+
+    /**
+     * Set the reachability of all given locations using the latest result, if there is one which wasn't applied yet.
+     * @return true if locations were updated
+     */
+    bool apply_result(std::vector<Location>& locations);
+
+    /// Save the cache to its current file, then switch to (and load) the cache stored in given file
+    void load_cache(const std::string& file_path);
+    void save_cache();
+
+private:
+    void run();
+    /// @return reachability of all locations with given preset, or nothing if solving failed
+    std::optional<ReachabilityCache::Bitset> solve(const nlohmann::json& preset);
+};
@@ -5,16 +5,24 @@
 #include <filesystem>
 #include <random>
 #include <regex>
-#include <landstalker_lib/constants/item_codes.hpp>
+#include <optional>
 
 #include "multiworld_interfaces/archipelago_interface.hpp"
 #include "multiworld_interfaces/offline_play_interface.hpp"
 #include "emulator_interfaces/retroarch_mem_interface.hpp"
 #include "emulator_interfaces/bizhawk_mem_interface.hpp"
+#include "emulator_interfaces/game_ram_snapshot.hpp"
+#include "emulator_interfaces/recording_emulator_interface.hpp"
+#include "emulator_interfaces/replay_emulator_interface.hpp"
 #include "game_state.hpp"
+#include "game_polling.hpp"
 #include "user_interface.hpp"
 #include "logger.hpp"
 #include "randstalker_invoker.hpp"
+#include "logic_solver.hpp"
+#include "poll_scheduler.hpp"
+#include "latency_stats.hpp"
+#include "client.hpp"
 
 
 #ifndef DEBUG
@@ -28,24 +36,24 @@ GameState game_state;
 MultiworldInterface* multiworld = nullptr;
 EmulatorInterface* emulator = nullptr;
 std::mutex session_mutex;
-
-constexpr uint16_t ADDR_RECEIVED_ITEM = 0x0020;                 // 1 byte long
-constexpr uint16_t ADDR_DEATHLINK_STATE = 0x0021;               // 1 byte long
-constexpr uint16_t ADDR_SEED = 0x0022;                          // 4 bytes long
-constexpr uint16_t ADDR_COMPLETION_BYTE = 0x0028;               // 1 byte long
-constexpr uint16_t ADDR_IS_IN_GAME = 0x1200;
-constexpr uint16_t ADDR_CURRENT_RECEIVED_ITEM_INDEX = 0x107E;
-constexpr uint16_t ADDR_CURRENT_HEALTH = 0x543E;
-
-constexpr uint8_t DEATHLINK_STATE_IDLE = 0;
-constexpr uint8_t DEATHLINK_STATE_RECEIVED_DEATH = 1;
-constexpr uint8_t DEATHLINK_STATE_WAIT_FOR_RESURRECT = 2;
-
-constexpr uint8_t ITEM_PROGRESSIVE_ARMOR = 69; // 0x45
-constexpr uint8_t ITEM_ARCHIPELAGO_KAZALT_JEWEL = 70; // 0x46
+PollScheduler scheduler;
+LogicSolver logic_solver;
+PollScheduler::TaskId archipelago_task;
+PollScheduler::TaskId item_delivery_task;
+
+/// Events emitted by the game side, to be transmitted to the multiworld
+MpscQueue<SessionEvent> game_events;
+/// Events emitted by the game side, to be handled by the UI thread
+MpscQueue<SessionEvent> ui_events;
+
+/// Called by the network thread when it has pushed a new event, to process it right away
+static void wake_archipelago_task()
+{
+    scheduler.wake(archipelago_task);
+}
 
 #define INTERNAL_PRESET_FILE_PATH "./_preset.json"
-#define SOLVE_LOGIC_PRESET_FILE_PATH "./_solve_logic.json"
+#define LATENCY_STATS_FILE_PATH "./latency_stats.json"
 
 static uint32_t generate_random_seed()
 {
@@ -78,10 +86,11 @@ void update_map_tracker_logic()
     logic_solve_preset["randomizerSettings"]["enemyJumpingInLogic"] = ui.tracker_config().enemy_jumping_in_logic;
     logic_solve_preset["randomizerSettings"]["treeCuttingGlitchInLogic"] = ui.tracker_config().tree_cutting_glitch_in_logic;
 
+    std::shared_ptr<const GameStateSnapshot> snapshot = game_state.snapshot();
     for(TrackableItem* item : ui.trackable_items())
-        if(game_state.owned_item_quantity(item->item_id()) > 0)
+        if(snapshot->owned_item_quantity(item->item_id()) > 0)
             if(item->name() != "Kazalt Jewel")
-                logic_solve_preset["gameSettings"]["startingItems"][item->name()] = game_state.owned_item_quantity(item->item_id());
+                logic_solve_preset["gameSettings"]["startingItems"][item->name()] = snapshot->owned_item_quantity(item->item_id());
 
     std::string spawn_location = ui.tracker_config().spawn_location;
     for(char& c : spawn_location)
@@ -111,27 +120,29 @@ void update_map_tracker_logic()
         }
     }
 
-    std::ofstream preset_file(SOLVE_LOGIC_PRESET_FILE_PATH);
-    preset_file << logic_solve_preset.dump();
-    preset_file.close();
-
-    std::string command = "randstalker.exe";
-    command += " --preset=\"" SOLVE_LOGIC_PRESET_FILE_PATH "\"";
-    command += " --solvelogic";
+    // Next state is most likely to be the current one with one more item, so have these solved in advance as well
+    std::vector<nlohmann::json> speculative_presets;
+    for(TrackableItem* item : ui.trackable_items())
+    {
+        if(snapshot->owned_item_quantity(item->item_id()) > 0 || item->name() == "Kazalt Jewel")
+            continue;
+        if(!ui.tracker_config().item_exists_in_game(item))
+            continue;
 
-    std::set<std::string> reachable_locations = invoke_randstalker_to_solve_logic(command);
-    for(Location& loc : game_state.locations())
-        loc.reachable(reachable_locations.contains(loc.name()));
+        nlohmann::json speculative_preset = logic_solve_preset;
+        speculative_preset["gameSettings"]["startingItems"][item->name()] = 1;
+        speculative_presets.emplace_back(std::move(speculative_preset));
+    }
 
-#ifndef DEBUG
-    std::filesystem::remove(std::filesystem::path(SOLVE_LOGIC_PRESET_FILE_PATH));
-#endif
+    // Solving happens in the background, result is applied to locations by process_ui_events()
+    logic_solver.request_solve(std::move(logic_solve_preset), speculative_presets);
 }
 
 void initiate_solo_session()
 {
     session_mutex.lock();
     game_state.reset();
+    logic_solver.cancel();
     multiworld = new OfflinePlayInterface();
     session_mutex.unlock();
 }
@@ -152,52 +163,16 @@ void connect_ap(std::string host, const std::string& slot_name, const std::strin
 
     session_mutex.lock();
     game_state.reset();
+    logic_solver.cancel();
+    session_mutex.unlock();
 
     Logger::info("Attempting to connect to Archipelago server at '" + host + "'...");
 
-    if(host.find("ws://") != 0 && host.find("wss://") != 0)
-    {
-        // Protocol not given: try both and see which one wins
-        ArchipelagoInterface* wss_multiworld = new ArchipelagoInterface("wss://" + host, slot_name, password);
-        ArchipelagoInterface* ws_multiworld = new ArchipelagoInterface("ws://" + host, slot_name, password);
-        multiworld = nullptr;
-
-        constexpr uint32_t WAIT_MILLIS = 100;
-        constexpr uint32_t TIMEOUT_MILLIS = 5000;
-        for(uint32_t i=0 ; i<TIMEOUT_MILLIS ; i += WAIT_MILLIS)
-        {
-            wss_multiworld->poll();
-            if(wss_multiworld->is_connected())
-            {
-                multiworld = wss_multiworld;
-                delete ws_multiworld;
-                break;
-            }
-
-            ws_multiworld->poll();
-            if(ws_multiworld->is_connected())
-            {
-                multiworld = ws_multiworld;
-                delete wss_multiworld;
-                break;
-            }
-
-            std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_MILLIS));
-        }
-
-        if(!multiworld)
-        {
-            Logger::error("Could not connect to Archipelago server");
-            delete ws_multiworld;
-            delete wss_multiworld;
-        }
-    }
-    else
-    {
-        // Protocol given: use the parameters that were explicitly passed
-        multiworld = new ArchipelagoInterface(host, slot_name, password);
-    }
+    // Connection (and ws / wss detection when no scheme is given) happens on the interface's own network thread
+    MultiworldInterface* new_multiworld = new ArchipelagoInterface(host, slot_name, password, wake_archipelago_task);
 
+    session_mutex.lock();
+    multiworld = new_multiworld;
     session_mutex.unlock();
 }
 
@@ -210,45 +185,94 @@ void disconnect_ap()
     delete emulator;
     emulator = nullptr;
     game_state.reset();
+    logic_solver.cancel();
+    while(game_events.pop()) {}
     ui.tracker_config().save_to_file();
     ui.tracker_config().file_path = "";
+    logic_solver.load_cache("");
     session_mutex.unlock();
 }
 
 void connect_emu()
 {
-    session_mutex.lock();
+    // Attaching to the emulator can take some time (e.g. when looking for RAM), so session is only locked afterwards
+    EmulatorInterface* new_emulator = nullptr;
     try
     {
-        emulator = new RetroarchMemInterface();
+        new_emulator = new RetroarchMemInterface();
         Logger::info("Successfully connected to Retroarch.");
     }
     catch(EmulatorException& e)
     {
-        emulator = nullptr;
+        new_emulator = nullptr;
         std::cout << e.message() << std::endl;
     }
 
-    if(!emulator)
+    if(!new_emulator)
     {
         try
         {
-            emulator = new BizhawkMemInterface();
+            new_emulator = new BizhawkMemInterface();
             Logger::info("Successfully connected to Bizhawk.");
         }
         catch(EmulatorException& e)
         {
-            emulator = nullptr;
+            new_emulator = nullptr;
             std::cout << e.message() << std::endl;
         }
     }
 
-    if(!emulator)
+    if(!new_emulator)
     {
         Logger::error("Could not find a valid emulator process currently running the game to connect to.");
+        return;
     }
 
+    session_mutex.lock();
+    delete emulator;
+    emulator = new_emulator;
+    // Flags from a previous emulator have nothing to do with this one, make sure all flags are reconsidered
+    game_state.location_flags_watcher().reset();
     session_mutex.unlock();
+
+    scheduler.idle(false);
+}
+
+/**
+ * Apply an event coming from the multiworld to the game state, waking up item delivery if something needs
+ * to be transmitted to the game
+ */
+static void process_multiworld_event(const SessionEvent& event)
+{
+    if(event.type == SessionEvent::Type::SLOT_CONNECTED)
+    {
+        game_state.has_deathlink(event.has_deathlink);
+        game_state.expected_seed(event.seed);
+        pending_item_timestamps.clear();
+        death_received_timestamp.reset();
+
+        // Locations checked while connection was lost might never have reached the server: send them all again,
+        // the multiworld interface only keeps those the server did not acknowledge yet.
+        SessionEvent locations_event { .type = SessionEvent::Type::LOCATIONS_CHECKED };
+        locations_event.location_ids = game_state.checked_locations();
+        if(!locations_event.location_ids.empty())
+            game_events.push(locations_event);
+
+        // Looking for an already built ROM is a matter for the UI
+        ui_events.push(event);
+    }
+    else if(event.type == SessionEvent::Type::ITEM_RECEIVED)
+    {
+        game_state.set_received_item(event.item_index, event.item_id);
+        pending_item_timestamps[event.item_index] = PendingItemTimestamps { .received = event.timestamp };
+        scheduler.wake(item_delivery_task);
+    }
+    else if(event.type == SessionEvent::Type::DEATH_RECEIVED && game_state.has_deathlink())
+    {
+        game_state.received_death(true);
+        death_received_timestamp = event.timestamp;
+        scheduler.wake(item_delivery_task);
+    }
 }
 
 void poll_archipelago()
@@ -256,8 +280,6 @@ void poll_archipelago()
     if(!multiworld)
         return;
 
-    multiworld->poll();
-
     if(multiworld->connection_failed())
     {
         delete multiworld;
@@ -265,139 +287,98 @@ void poll_archipelago()
         return;
     }
 
+    while(std::optional<SessionEvent> event = multiworld->events().pop())
+        process_multiworld_event(*event);
+
+    // Game events are kept in queue until there is a connection to send them through
     if(!multiworld->is_connected())
         return;
 
-    if(game_state.must_send_checked_locations())
-    {
-        // Send newly checked locations to server
-        multiworld->send_checked_locations_to_server(game_state.checked_locations());
-
-        game_state.must_send_checked_locations(false);
-    }
-
-    if(game_state.has_won())
-        multiworld->notify_game_completed();
+    // All location checks found during this tick are coalesced into a single packet. They still need to be sent
+    // before any other event (e.g. goal completion) to keep the order in which things happened in-game.
+    std::vector<int64_t> checked_location_ids;
+    std::vector<LatencyStats::Clock::time_point> checked_location_timestamps;
+    auto flush_checked_locations = [&checked_location_ids, &checked_location_timestamps]() {
+        if(checked_location_ids.empty())
+            return;
+        multiworld->send_checked_locations_to_server(checked_location_ids);
+        for(LatencyStats::Clock::time_point timestamp : checked_location_timestamps)
+            LatencyStats::get().record_since(LatencyStats::LOCATION_CHECKED_TO_SENT, timestamp);
+        checked_location_ids.clear();
+        checked_location_timestamps.clear();
+    };
+
+    while(std::optional<SessionEvent> event = game_events.pop())
+    {
+        if(event->type == SessionEvent::Type::LOCATIONS_CHECKED)
+        {
+            checked_location_ids.insert(checked_location_ids.end(), event->location_ids.begin(), event->location_ids.end());
+            checked_location_timestamps.insert(checked_location_timestamps.end(), event->location_ids.size(), event->timestamp);
+            continue;
+        }
 
-    if(game_state.must_send_death())
-    {
-        multiworld->notify_death();
-        game_state.must_send_death(false);
+        flush_checked_locations();
+        if(event->type == SessionEvent::Type::GOAL_COMPLETED)
+            multiworld->notify_game_completed();
+        else if(event->type == SessionEvent::Type::PLAYER_DIED)
+            multiworld->notify_death();
     }
+    flush_checked_locations();
 }
 
-void poll_emulator()
+/**
+ * Run a task interacting with the emulator, taking care of locking the session and dropping the emulator
+ * if it cannot be accessed anymore.
+ */
+static void run_emulator_task(void (*task)())
 {
-    if((multiworld && !multiworld->is_offline_session()) && emulator->read_game_long(ADDR_SEED) != game_state.expected_seed())
+    session_mutex.lock();
+    if(!emulator)
     {
-        delete emulator;
-        emulator = nullptr;
-        Logger::error("Invalid seed. Please ensure the right ROM was loaded.");
+        scheduler.idle(true);
+        session_mutex.unlock();
         return;
     }
 
-    // If no save file is currently loaded, no need to do anything
-    if(emulator->read_game_word(ADDR_IS_IN_GAME) == 0x00)
-        return;
-
-    // Test all location flags to see if player checked new locations since last poll
-    for(Location& location : game_state.locations())
+    try
     {
-        if(location.was_checked())
-            continue;
-
-        uint8_t flag_byte_value = emulator->read_game_byte(location.checked_flag_byte());
-        uint8_t flag_bit_value = (flag_byte_value >> location.checked_flag_bit()) & 0x1;
-        if(flag_bit_value != 0)
-        {
-            location.was_checked(true);
-            game_state.must_send_checked_locations(true);
-        }
+        task();
     }
-
-    // If there are received items that are not yet processed, send the next pending one to the player
-    uint16_t current_item_index_in_game = emulator->read_game_word(ADDR_CURRENT_RECEIVED_ITEM_INDEX);
-    if(game_state.current_item_index() > current_item_index_in_game)
+    catch(EmulatorException& ex)
     {
-        if(emulator->read_game_byte(ADDR_RECEIVED_ITEM) == 0xFF)
-        {
-            uint8_t item_id = game_state.item_with_index(current_item_index_in_game);
-
-            // If the item is a progressive armor, look at the armors owned by the player and give them the next tier.
-            // Technically, we *could* send any kind of armor and the next tier would be received in-game, but the
-            // item name inside the "Got <ITEM>" textbox when an item is received directly depends on this ID.
-            if(item_id == ITEM_PROGRESSIVE_ARMOR)
-            {
-                uint32_t owned_armors = emulator->read_game_word(0x1044);
-                if((owned_armors & 0x2000) == 0)
-                    item_id = ITEM_STEEL_BREAST;
-                else if((owned_armors & 0x0002) == 0)
-                    item_id = ITEM_CHROME_BREAST;
-                else if((owned_armors & 0x0020) == 0)
-                    item_id = ITEM_SHELL_BREAST;
-                else
-                    item_id = ITEM_HYPER_BREAST;
-            }
-            else if(item_id == ITEM_ARCHIPELAGO_KAZALT_JEWEL)
-            {
-                // Kazalt Jewel over Archipelago is a fake item that needs to be converted into a Red Jewel on reception
-                item_id = ITEM_RED_JEWEL;
-            }
-
-            emulator->write_game_byte(ADDR_RECEIVED_ITEM, item_id);
-        }
+        Logger::error(ex.message());
+        delete emulator;
+        emulator = nullptr;
     }
 
-    // Check goal completion
-    if(emulator->read_game_byte(ADDR_COMPLETION_BYTE) == 0x01)
-    {
-        game_state.has_won(true);
-        emulator->write_game_byte(ADDR_COMPLETION_BYTE, 0x00);
-    }
+    if(!emulator)
+        scheduler.idle(true);
+    session_mutex.unlock();
+}
 
-    // Update inventory bytes for the item tracker
-    bool inventory_changed = false;
-    constexpr uint32_t INVENTORY_START_ADDR = 0xFF1040;
-    for(uint8_t i=0 ; i<0x20 ; ++i)
-    {
-        uint8_t byte_value = emulator->read_game_byte(INVENTORY_START_ADDR + i);
-        if(game_state.update_inventory_byte(i, byte_value))
-            inventory_changed = true;
+static void run_archipelago_task()
+{
+    session_mutex.lock();
+    poll_archipelago();
+    session_mutex.unlock();
+}
+
+void process_ui_events()
+{
+    // Several inventory changes in a row only need one logic update
+    bool must_update_logic = false;
+    while(std::optional<SessionEvent> event = ui_events.pop())
+    {
+        if(event->type == SessionEvent::Type::SLOT_CONNECTED)
+            check_rom_existence(event->seed, event->player_name);
+        else if(event->type == SessionEvent::Type::INVENTORY_CHANGED)
+            must_update_logic = true;
     }
 
-    // If any of the inventory values changed, update logic for the map tracker
-    if(inventory_changed)
+    if(must_update_logic)
         update_map_tracker_logic();
 
-    // Handle deathlink, both ways
-    if(game_state.has_deathlink())
-    {
-        // If another player died and we received the death notification, schedule a death
-        if(game_state.received_death() && emulator->read_game_byte(ADDR_DEATHLINK_STATE) == DEATHLINK_STATE_IDLE)
-        {
-            Logger::debug("Processing received death...");
-            emulator->write_game_byte(ADDR_DEATHLINK_STATE, DEATHLINK_STATE_RECEIVED_DEATH);
-            game_state.received_death(false);
-        }
-
-        // If player just died, send a death notification to other players
-        if(emulator->read_game_word(ADDR_CURRENT_HEALTH) == 0x0000)
-        {
-            // Check that this death wasn't caused by a recent received death or already processed
-            if(!game_state.must_send_death() && emulator->read_game_byte(ADDR_DEATHLINK_STATE) == DEATHLINK_STATE_IDLE)
-            {
-                Logger::debug("Player death detected");
-                emulator->write_game_byte(ADDR_DEATHLINK_STATE, DEATHLINK_STATE_WAIT_FOR_RESURRECT);
-                game_state.must_send_death(true);
-            }
-        }
-        else if(emulator->read_game_byte(ADDR_DEATHLINK_STATE) == DEATHLINK_STATE_WAIT_FOR_RESURRECT)
-        {
-            // Player has life and is in a "post deathlink" state, clear it back to normal to make
-            // dying from deathlink and sending deaths possible again
-            emulator->write_game_byte(ADDR_DEATHLINK_STATE, DEATHLINK_STATE_IDLE);
-        }
-    }
+    logic_solver.apply_result(game_state.locations());
 }
 
 static std::string get_output_rom_path(uint32_t seed, const std::string& player_name)
@@ -433,6 +414,7 @@ void check_rom_existence(uint32_t seed, const std::string& player_name)
         // Load the tracker data from a potential previous seating, since the ROM was already there
         ui.tracker_config().file_path = std::regex_replace(output_path, std::regex("\\.md"), ".json");
         ui.tracker_config().load_from_file();
+        logic_solver.load_cache(std::regex_replace(output_path, std::regex("\\.md"), ".logic_cache.json"));
     }
     else Logger::info("ROM not found!");
 }
@@ -476,14 +458,22 @@ std::string build_rom()
             command += " --outputrom=\"\"";
             command += " --nostdin";
 
+            // Don't prevent the poll loop from running while randstalker parses the permalink. Offline sessions
+            // are only ever replaced from the UI thread, so the session is still the same one afterwards.
+            session_mutex.unlock();
+
+            // Running randstalker is heavy enough without the map tracker solving things in advance at the same time
+            logic_solver.pause_speculation(true);
             bool success = invoke(command);
+            logic_solver.pause_speculation(false);
             if(!success)
             {
                 Logger::error("Failed to parse permalink, please check it is correct.");
-                session_mutex.unlock();
                 return "";
             }
 
+            session_mutex.lock();
+
             std::ifstream preset_file(INTERNAL_PRESET_FILE_PATH);
             if(!preset_file.is_open())
             {
@@ -520,14 +510,15 @@ std::string build_rom()
     else
     {
         ArchipelagoInterface* archipelago = reinterpret_cast<ArchipelagoInterface*>(multiworld);
-        if(archipelago->locations_data().empty())
+        std::shared_ptr<const ScoutedLocations> scouted_locations = archipelago->scouted_locations();
+        if(!scouted_locations || scouted_locations->empty())
         {
             Logger::error("Client is still waiting for data from the server. Please wait before trying again.");
             session_mutex.unlock();
             return "";
         }
 
-        preset_json = build_preset_json(archipelago->slot_data(), archipelago->locations_data(), archipelago->player_name());
+        preset_json = build_preset_json(archipelago->slot_data(), *scouted_locations, archipelago->player_name());
     }
 
     std::string dump = preset_json.dump(4);
@@ -537,6 +528,7 @@ std::string build_rom()
     // Autofill all tracker settings that can be deduced from the preset
     ui.tracker_config().build_from_preset(preset_json);
     ui.tracker_config().file_path = std::regex_replace(output_path, std::regex("\\.md"), ".json");
+    logic_solver.load_cache(std::regex_replace(output_path, std::regex("\\.md"), ".logic_cache.json"));
 
     // Remove shuffle trees if teleport tree pairs are explicitly defined
     if(preset_json.contains("world") && preset_json["world"].contains("teleportTreePairs"))
@@ -557,7 +549,10 @@ std::string build_rom()
     command += " --preset=\"" INTERNAL_PRESET_FILE_PATH "\"";
     command += " --nostdin";
 
+    // Running randstalker is heavy enough without the map tracker solving things in advance at the same time
+    logic_solver.pause_speculation(true);
     bool success = invoke(command);
+    logic_solver.pause_speculation(false);
 
 #ifndef DEBUG
     std::filesystem::remove(std::filesystem::path(INTERNAL_PRESET_FILE_PATH));
@@ -567,6 +562,7 @@ std::string build_rom()
     {
         Logger::info("ROM built successfully at \"" + output_path + "\".");
         ui.tracker_config().save_to_file();
+        logic_solver.save_cache();
         return output_path;
     }
     else
@@ -582,12 +578,12 @@ void process_console_input(const std::string& input)
     if(input == "!senddeath" && game_state.has_deathlink())
     {
         Logger::debug("Fake death queued for sending");
-        game_state.must_send_death(true);
+        game_events.push(SessionEvent { .type = SessionEvent::Type::PLAYER_DIED });
     }
-    else if(input == "!receivedeath" && game_state.has_deathlink())
+    else if(input == "!receivedeath" && game_state.has_deathlink() && multiworld)
     {
         Logger::debug("Fake death registered as received");
-        game_state.received_death(true);
+        multiworld->events().push(SessionEvent { .type = SessionEvent::Type::DEATH_RECEIVED });
     }
     else if(input == "!giveallitems" && emulator)
     {
@@ -603,6 +599,7 @@ void process_console_input(const std::string& input)
     else if(input == "!collectallchecks" && emulator)
     {
         Logger::debug("Collecting all checks...");
+        session_mutex.lock();
         for(Location& loc : game_state.locations())
         {
             uint8_t flag_byte_value = emulator->read_game_byte(loc.checked_flag_byte());
@@ -610,10 +607,91 @@ void process_console_input(const std::string& input)
             emulator->write_game_byte(loc.checked_flag_byte(), flag_byte_value | or_mask);
             loc.was_checked(true);
         }
+        game_state.publish_snapshot();
+        session_mutex.unlock();
+    }
+    else if(input.starts_with("!record ") && emulator)
+    {
+        // Record all reads & writes made to the emulator into a trace file, to be played back later using !replay
+        std::string path = input.substr(8);
+        session_mutex.lock();
+        try
+        {
+            emulator = new RecordingEmulatorInterface(emulator, path);
+            Logger::debug("Recording emulator session into '" + path + "'...");
+        }
+        catch(EmulatorException& e)
+        {
+            Logger::error(e.message());
+        }
+        session_mutex.unlock();
+    }
+    else if(input == "!stoprecord")
+    {
+        session_mutex.lock();
+        auto* recorder = dynamic_cast<RecordingEmulatorInterface*>(emulator);
+        if(recorder)
+        {
+            emulator = recorder->release();
+            delete recorder;
+            Logger::debug("Stopped recording emulator session.");
+        }
+        session_mutex.unlock();
+    }
+    else if(input.starts_with("!replay ") || input.starts_with("!replayfast "))
+    {
+        // Replace the emulator by the playback of a trace file, either in real-time or as fast as it is polled
+        bool real_time = input.starts_with("!replay ");
+        std::string path = input.substr(input.find(' ') + 1);
+        try
+        {
+            EmulatorInterface* replay = new ReplayEmulatorInterface(path, real_time);
+            session_mutex.lock();
+            delete emulator;
+            emulator = replay;
+            game_state.location_flags_watcher().reset();
+            session_mutex.unlock();
+            scheduler.idle(false);
+            Logger::debug("Replaying emulator session from '" + path + "'...");
+        }
+        catch(EmulatorException& e)
+        {
+            Logger::error(e.message());
+        }
+    }
+    else if(input.starts_with("!recordpackets ") || input == "!stoprecordpackets")
+    {
+        // Capture packets received from the server into a trace that can be replayed by tools/ap_stub_server
+        std::string path = input.starts_with("!recordpackets ") ? input.substr(15) : "";
+        session_mutex.lock();
+        if(multiworld && !multiworld->is_offline_session())
+        {
+            reinterpret_cast<ArchipelagoInterface*>(multiworld)->capture_packets(path);
+            if(path.empty())
+                Logger::debug("Stopped recording server packets.");
+            else
+                Logger::debug("Recording server packets into '" + path + "'...");
+        }
+        session_mutex.unlock();
     }
     else
 #endif
-    if(input == "/about")
+    if(input == "/latency")
+    {
+        Logger::info("Latency over the last " + std::to_string(LatencyStats::WINDOW_SIZE) + " samples (p50 / p95 / p99):");
+        for(int i=0 ; i<LatencyStats::STAGE_COUNT ; ++i)
+        {
+            auto stage = static_cast<LatencyStats::Stage>(i);
+            LatencyStats::Summary summary = LatencyStats::get().summary(stage);
+            Logger::message(std::string(LatencyStats::stage_name(stage)) + ": " + std::to_string(summary.p50) + " / "
+                            + std::to_string(summary.p95) + " / " + std::to_string(summary.p99) + " ms ("
+                            + std::to_string(summary.total_count) + " samples)");
+        }
+
+        if(LatencyStats::get().export_to_file(LATENCY_STATS_FILE_PATH))
+            Logger::info("Latency stats exported to '" LATENCY_STATS_FILE_PATH "'.");
+    }
+    else if(input == "/about")
     {
         Logger::info("About Randstalker Archipelago Client v" RELEASE);
         Logger::message("Development of Randstalker, this client and the whole Landstalker integration in Archipelago");
@@ -657,32 +735,21 @@ int main()
     Logger::info("Use /about for full credits");
     Logger::info("Have fun randomizing!");
 
-    // Network + game handling thread
+    // Network + game handling tasks, each one running at its own pace. Emulator tasks switch to their much longer
+    // idle period when there is no emulator attached or no save file loaded.
+    using std::chrono::milliseconds;
+    archipelago_task = scheduler.add_task("archipelago", milliseconds(250), milliseconds(250), 4, run_archipelago_task);
+    scheduler.add_task("seed", milliseconds(3000), milliseconds(3000), 3, [](){ run_emulator_task(check_seed); });
+    item_delivery_task = scheduler.add_task("item_delivery", milliseconds(100), milliseconds(1000), 2,
+                                            [](){ run_emulator_task(poll_item_delivery); });
+    scheduler.add_task("locations", milliseconds(250), milliseconds(1000), 1, [](){ run_emulator_task(poll_locations); });
+    scheduler.add_task("inventory", milliseconds(500), milliseconds(2000), 0, [](){ run_emulator_task(poll_inventory); });
+    scheduler.idle(true);
+
     std::thread process_thread([&keep_working]()
     {
         while(keep_working)
-        {
-            session_mutex.lock();
-            {
-                poll_archipelago();
-
-                if(emulator)
-                {
-                    try
-                    {
-                        poll_emulator();
-                    }
-                    catch(EmulatorException& ex)
-                    {
-                        Logger::error(ex.message());
-                        delete emulator;
-                        emulator = nullptr;
-                    }
-                }
-            }
-            session_mutex.unlock();
-            std::this_thread::sleep_for(std::chrono::milliseconds(150));
-        }
+            scheduler.run_pending_tasks();
     });
 
     // UI thread
@@ -690,7 +757,11 @@ int main()
 
     // When UI is closed, tell the other thread to stop working
     ui.tracker_config().save_to_file();
+    logic_solver.save_cache();
+    if(LatencyStats::get().has_samples())
+        LatencyStats::get().export_to_file(LATENCY_STATS_FILE_PATH);
     keep_working = false;
+    scheduler.stop();
     process_thread.join();
     return EXIT_SUCCESS;
 }
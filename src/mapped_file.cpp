@@ -0,0 +1,102 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return;
+    _file_handle = file;
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+    {
+        this->close();
+        return;
+    }
+
+    _mapping_handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!_mapping_handle)
+    {
+        this->close();
+        return;
+    }
+
+    _data = reinterpret_cast<const uint8_t*>(MapViewOfFile(_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if(!_data)
+    {
+        this->close();
+        return;
+    }
+    _size = static_cast<size_t>(file_size.QuadPart);
+}
+
+void MappedFile::close()
+{
+    if(_data)
+        UnmapViewOfFile(_data);
+    if(_mapping_handle)
+        CloseHandle(_mapping_handle);
+    if(_file_handle)
+        CloseHandle(_file_handle);
+
+    _data = nullptr;
+    _size = 0;
+    _mapping_handle = nullptr;
+    _file_handle = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+    _file_descriptor = open(path.c_str(), O_RDONLY);
+    if(_file_descriptor < 0)
+        return;
+
+    struct stat file_stat {};
+    if(fstat(_file_descriptor, &file_stat) != 0 || file_stat.st_size == 0)
+    {
+        this->close();
+        return;
+    }
+
+    void* data = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, _file_descriptor, 0);
+    if(data == MAP_FAILED)
+    {
+        this->close();
+        return;
+    }
+    _data = reinterpret_cast<const uint8_t*>(data);
+    _size = static_cast<size_t>(file_stat.st_size);
+}
+
+void MappedFile::close()
+{
+    if(_data)
+        munmap(const_cast<uint8_t*>(_data), _size);
+    if(_file_descriptor >= 0)
+        ::close(_file_descriptor);
+
+    _data = nullptr;
+    _size = 0;
+    _file_descriptor = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    this->close();
+}
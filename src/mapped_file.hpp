@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Read-only view of a whole file mapped into memory. Pages are only loaded by the OS when they are accessed,
+ * so only the parts of the file that are actually read cost anything.
+ */
+class MappedFile
+{
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    void* _file_handle = nullptr;
+    void* _mapping_handle = nullptr;
+#else
+    int _file_descriptor = -1;
+#endif
+
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Unmap the file, which is required on Windows before being able to replace it
+    void close();
+
+    [[nodiscard]] bool is_open() const { return _data != nullptr; }
+    [[nodiscard]] const uint8_t* data() const { return _data; }
+    [[nodiscard]] size_t size() const { return _size; }
+};
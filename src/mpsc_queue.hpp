@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+/**
+ * Unbounded lock-free queue allowing any number of threads to push values, and a single thread to pop them.
+ *
+ * This is used to pass events between the network, game and UI sides of the client, so that each of them
+ * only ever touches its own state instead of locking a shared one.
+ */
+template<typename T>
+class MpscQueue
+{
+private:
+    struct Node
+    {
+        std::atomic<Node*> next = nullptr;
+        T value {};
+    };
+
+    /// Last pushed node, only touched by producers
+    std::atomic<Node*> _head;
+    /// Last popped node (or initial empty node), only touched by the consumer
+    Node* _tail;
+
+public:
+    MpscQueue() : _head(new Node()), _tail(_head.load()) {}
+
+    ~MpscQueue()
+    {
+        while(this->pop()) {}
+        delete _tail;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value)
+    {
+        Node* node = new Node();
+        node->value = std::move(value);
+
+        // Producers only compete on the exchange, linking the previous node can be done afterwards. In-between,
+        // the consumer simply sees the queue as ending at the previous node.
+        Node* previous = _head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /// Pop the oldest value in the queue, or return an empty optional if there is none
+    std::optional<T> pop()
+    {
+        Node* next = _tail->next.load(std::memory_order_acquire);
+        if(!next)
+            return std::nullopt;
+
+        T value = std::move(next->value);
+        delete _tail;
+        _tail = next;
+        return value;
+    }
+};
@@ -5,143 +5,505 @@
 #include "apuuid.hpp"
 #include <fstream>
 
+#include "binary_datapackage_store.hpp"
 #include "../client.hpp"
 #include "../game_state.hpp"
 #include "../logger.hpp"
 
 #define GAME_NAME "Landstalker - The Treasures of King Nole"
-#define DATAPACKAGE_CACHE_FILE "datapackage.json"
+#define DATAPACKAGE_CACHE_FILE "datapackage.bin"
 #define UUID_FILE "uuid"
+#define CONNECTION_SCHEMES_FILE "connection_schemes.json"
 
 constexpr uint16_t ITEM_BASE_ID = 4000;
 
-ArchipelagoInterface::ArchipelagoInterface(const std::string& uri, std::string slot_name, std::string password) :
-    _slot_name  (std::move(slot_name)),
-    _password   (std::move(password))
+/// Maximum time spent by the network thread between two websocket polls when there is nothing to send
+constexpr std::chrono::milliseconds NETWORK_POLL_PERIOD(5);
+
+/// Head start given to the scheme which worked last time for a host, before racing it with the other scheme
+constexpr std::chrono::milliseconds HAPPY_EYEBALLS_DELAY(250);
+/// Time after which a connection race without any winner is considered as failed
+constexpr std::chrono::milliseconds CONNECTION_RACE_TIMEOUT(5000);
+
+/**
+ * Render a PrintJSON message as plain text. APClient is only given placeholder datapackages (see
+ * BinaryDataPackageStore), so names need to be resolved using our own lookup tables.
+ */
+static std::string render_text(const std::list<APClient::TextNode>& nodes, const DataPackageLookup& names)
+{
+    std::string text;
+    for(const APClient::TextNode& node : nodes)
+    {
+        if(node.type == "player_id")
+            text += names.player_alias(std::stoi(node.text));
+        else if(node.type == "item_id")
+            text += names.item_name(std::stoll(node.text), node.player);
+        else if(node.type == "location_id")
+            text += names.location_name(std::stoll(node.text), node.player);
+        else
+            text += node.text;
+    }
+    return text;
+}
+
+/// @return the scheme ("ws" or "wss") that worked last time a connection was made to given host, if any
+static std::string preferred_scheme(const std::string& host)
+{
+    std::ifstream file(CONNECTION_SCHEMES_FILE);
+    if(!file)
+        return "";
+
+    json schemes = json::parse(file, nullptr, false);
+    if(schemes.is_discarded() || !schemes.is_object() || !schemes[host].is_string())
+        return "";
+    return schemes[host];
+}
+
+static void save_preferred_scheme(const std::string& host, const std::string& scheme)
+{
+    json schemes = json::object();
+    {
+        std::ifstream file(CONNECTION_SCHEMES_FILE);
+        if(file)
+            schemes = json::parse(file, nullptr, false);
+    }
+    if(schemes.is_discarded() || !schemes.is_object())
+        schemes = json::object();
+
+    if(schemes[host] == scheme)
+        return;
+    schemes[host] = scheme;
+    std::ofstream(CONNECTION_SCHEMES_FILE) << schemes.dump(4);
+}
+
+ArchipelagoInterface::ArchipelagoInterface(const std::string& host, std::string slot_name, std::string password,
+                                           std::function<void()> event_handler) :
+    MultiworldInterface (std::move(event_handler)),
+    _connection_start   (Clock::now()),
+    _slot_name          (std::move(slot_name)),
+    _password           (std::move(password))
 {
-    std::string uuid = ap_get_uuid(UUID_FILE);
-    Logger::debug("UUID is " + uuid);
+    _uuid = ap_get_uuid(UUID_FILE);
+    Logger::debug("UUID is " + _uuid);
 
-    _client = new APClient(uuid, GAME_NAME, uri);
+    if(host.find("ws://") == 0 || host.find("wss://") == 0)
+    {
+        // Protocol given: use the parameters that were explicitly passed
+        _connection_attempts.emplace_back(ConnectionAttempt { .uri = host, .start_delay = std::chrono::milliseconds(0) });
+    }
+    else
+    {
+        // Protocol not given: race both, starting with the one which worked last time (if any)
+        _host = host;
+        std::vector<std::string> schemes = { "wss", "ws" };
+        auto start_delay = std::chrono::milliseconds(0);
+        if(preferred_scheme(host) == "ws")
+            std::swap(schemes[0], schemes[1]);
+        if(!preferred_scheme(host).empty())
+            start_delay = HAPPY_EYEBALLS_DELAY;
+
+        _connection_attempts.emplace_back(ConnectionAttempt { .uri = schemes[0] + "://" + host, .start_delay = std::chrono::milliseconds(0) });
+        _connection_attempts.emplace_back(ConnectionAttempt { .uri = schemes[1] + "://" + host, .start_delay = start_delay });
+    }
 
-    this->init_handlers();
+    _datapackage_store = new BinaryDataPackageStore(DATAPACKAGE_CACHE_FILE, _names);
+    _network_thread = std::thread(&ArchipelagoInterface::run_network_thread, this);
 }
 
 ArchipelagoInterface::~ArchipelagoInterface()
 {
+    {
+        std::lock_guard lock(_network_mutex);
+        _stopped = true;
+    }
+    _network_condition.notify_one();
+    _network_thread.join();
+
+    _journal.reset();
+    for(ConnectionAttempt& attempt : _connection_attempts)
+        delete attempt.client;
     delete _client;
+    delete _datapackage_store;
+}
+
+void ArchipelagoInterface::run_network_thread()
+{
+    std::unique_lock lock(_network_mutex);
+    while(!_stopped)
+    {
+        _has_pending_commands = false;
+        lock.unlock();
+
+        while(std::optional<std::function<void()>> command = _commands.pop())
+            (*command)();
+
+        if(_client)
+        {
+            _client->poll();
+        }
+        else
+        {
+            this->update_connection_attempts();
+            for(size_t i=0 ; i<_connection_attempts.size() && !_client ; ++i)
+                if(_connection_attempts[i].client)
+                    _connection_attempts[i].client->poll();
+        }
+
+        if(_journal)
+            _journal->flush();
+
+        lock.lock();
+        _network_condition.wait_for(lock, NETWORK_POLL_PERIOD, [this]() { return _stopped || _has_pending_commands; });
+    }
 }
 
-void ArchipelagoInterface::init_handlers()
+/**
+ * Start connection attempts once the attempts before them had their head start (or all failed), and drop the ones
+ * which failed. If no attempt could connect to its slot in time, the whole connection is considered as failed.
+ */
+void ArchipelagoInterface::update_connection_attempts()
 {
-    _client->set_socket_connected_handler([this](){ this->on_socket_connected(); });
-    _client->set_socket_disconnected_handler([this](){ this->on_socket_disconnected(); });
-    _client->set_room_info_handler([this](){ this->on_room_info(); });
+    if(_connection_attempts.empty())
+        return;
+
+    auto elapsed = Clock::now() - _connection_start;
+    bool has_running_attempt = false;
+    for(ConnectionAttempt& attempt : _connection_attempts)
+    {
+        if(attempt.failed)
+        {
+            delete attempt.client;
+            attempt.client = nullptr;
+            continue;
+        }
+
+        if(!attempt.client && (!has_running_attempt || elapsed >= attempt.start_delay))
+        {
+            Logger::debug("Attempting to connect using '" + attempt.uri + "'...");
+            attempt.client = new APClient(_uuid, GAME_NAME, attempt.uri, "", _datapackage_store);
+            this->init_handlers(attempt.client, &attempt - _connection_attempts.data());
+        }
+        has_running_attempt |= (attempt.client != nullptr);
+    }
+
+    // A single attempt (explicit scheme) keeps retrying on its own, just like any disconnected client would
+    if(_connection_attempts.size() > 1 && (!has_running_attempt || elapsed >= CONNECTION_RACE_TIMEOUT))
+    {
+        Logger::error("Could not connect to Archipelago server");
+        for(ConnectionAttempt& attempt : _connection_attempts)
+            delete attempt.client;
+        _connection_attempts.clear();
+        _connection_failed = true;
+    }
+}
+
+/**
+ * Make given connection attempt the client of the session, dropping all other attempts
+ */
+void ArchipelagoInterface::promote_connection_attempt(size_t attempt_index)
+{
+    ConnectionAttempt& winner = _connection_attempts[attempt_index];
+    _client = winner.client;
+    winner.client = nullptr;
+
+    auto connect_time = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - _connection_start);
+    Logger::debug("Connected using '" + winner.uri + "' in " + std::to_string(connect_time.count()) + "ms");
+    if(!_host.empty())
+        save_preferred_scheme(_host, winner.uri.substr(0, winner.uri.find("://")));
+
+    // Losing attempts are polled by the same thread, and are never polled again once a winner exists: they can
+    // be deleted right away, even if we are currently inside a handler of the winning client
+    for(ConnectionAttempt& attempt : _connection_attempts)
+        delete attempt.client;
+    _connection_attempts.clear();
+}
+
+/**
+ * Make the network thread run given command as soon as possible. This is the only way other threads
+ * are allowed to use the APClient.
+ */
+void ArchipelagoInterface::post_command(std::function<void()> command)
+{
+    _commands.push(std::move(command));
+    {
+        std::lock_guard lock(_network_mutex);
+        _has_pending_commands = true;
+    }
+    _network_condition.notify_one();
+}
+
+/**
+ * Bind handlers of given client, which is the client of connection attempt of given index. Until the client wins
+ * the connection race, only handlers related to the connection itself are processed.
+ */
+void ArchipelagoInterface::init_handlers(APClient* client, size_t attempt_index)
+{
+    client->set_socket_connected_handler([this, attempt_index](){ this->on_socket_connected(attempt_index); });
+    client->set_socket_error_handler([this, attempt_index](const std::string& error) {
+        this->on_socket_error(attempt_index, error);
+    });
+    client->set_socket_disconnected_handler([this, client]() {
+        if(client == _client)
+            this->on_socket_disconnected();
+    });
+    client->set_room_info_handler([this, client](){ this->on_room_info(client); });
+
+    client->set_slot_connected_handler([this, client, attempt_index](const json& j) {
+        if(!_client)
+            this->promote_connection_attempt(attempt_index);
+        if(client == _client)
+            this->on_slot_connected(j);
+    });
+    client->set_slot_refused_handler([this](const std::list<std::string>& errors){ this->on_slot_refused(errors); });
+
+    // Received games are only written to the cache file once all of them were received
+    client->set_data_package_changed_handler([this](const json&) {
+        _datapackage_store->flush();
+    });
+
+    client->set_room_update_handler([this, client]() {
+        if(client == _client)
+            this->on_players_changed();
+    });
+    client->set_slot_disconnected_handler([this, client]() {
+        if(client == _client)
+            this->on_slot_disconnected();
+    });
+
+    client->set_items_received_handler([this, client](const std::list<APClient::NetworkItem>& items) {
+        if(client != _client)
+            return;
 
-    _client->set_slot_connected_handler([this](const json& j){ this->on_slot_connected(j); });
-    _client->set_slot_disconnected_handler([this](){ this->on_slot_disconnected(); });
-    _client->set_slot_refused_handler([this](const std::list<std::string>& errors){ this->on_slot_refused(errors); });
+        if(_packet_capture.is_open() && !items.empty())
+        {
+            json packet = { { "cmd", "ReceivedItems" }, { "index", items.front().index }, { "items", json::array() } };
+            for (const auto& i : items)
+            {
+                packet["items"].emplace_back(json {
+                    { "item", i.item }, { "location", i.location }, { "player", i.player }, { "flags", i.flags }
+                });
+            }
+            this->capture_packet(packet);
+        }
 
-    _client->set_items_received_handler([this](const std::list<APClient::NetworkItem>& items) {
         for (const auto& i : items)
             this->on_item_received(i.index, i.item, i.player, i.location);
     });
 
-    _client->set_location_info_handler([this](const std::list<APClient::NetworkItem>& items) {
-        _locations_data = json::object();
+    client->set_location_info_handler([this, client](const std::list<APClient::NetworkItem>& items) {
+        if(client != _client)
+            return;
+
+        auto scouted_locations = std::make_shared<ScoutedLocations>();
+        scouted_locations->reserve(items.size());
         for (const auto& i : items)
-            this->on_item_scouted(i.index, i.item, i.player, i.location);
+            this->on_item_scouted(*scouted_locations, i.item, i.player, i.location);
+
+        if(_journal)
+        {
+            std::vector<SessionJournal::ScoutedLocation> journal_entries;
+            journal_entries.reserve(scouted_locations->entries().size());
+            for(const ScoutedLocations::Entry& entry : scouted_locations->entries())
+            {
+                journal_entries.emplace_back(SessionJournal::ScoutedLocation {
+                    .location = entry.location_id,
+                    .item = entry.item_id,
+                    .player = entry.player,
+                    .location_name = std::string(scouted_locations->name(entry.location_name)),
+                    .item_name = std::string(scouted_locations->name(entry.item_name)),
+                    .player_name = std::string(scouted_locations->name(entry.player_name))
+                });
+            }
+            _journal->record_scouted_locations(journal_entries);
+        }
+
+        std::lock_guard lock(_data_mutex);
+        _scouted_locations = std::move(scouted_locations);
+    });
+
+    client->set_bounced_handler([this, client](const json& cmd) {
+        if(client != _client)
+            return;
+        this->capture_packet(cmd);
+        this->on_bounced(cmd);
     });
 
-    _client->set_bounced_handler([this](const json& cmd) { this->on_bounced(cmd); });
+    client->set_print_handler([this, client](const std::string& msg) {
+        if(client == _client)
+            Logger::message(msg);
+    });
+    client->set_print_json_handler([this, client](const json& command) {
+        if(client != _client)
+            return;
+        this->capture_packet(command);
+
+        std::list<APClient::TextNode> msg;
+        for(const json& part : command["data"])
+            msg.emplace_back(APClient::TextNode::from_json(part));
+        Logger::message(render_text(msg, _names));
+    });
+}
 
-    _client->set_print_handler([](const std::string& msg) { Logger::message(msg); });
-    _client->set_print_json_handler([this](const std::list<APClient::TextNode>& msg) {
-        Logger::message(_client->render_json(msg, APClient::RenderFormat::TEXT));
+void ArchipelagoInterface::capture_packets(const std::string& path)
+{
+    this->post_command([this, path]() {
+        _packet_capture.close();
+        if(path.empty())
+            return;
+
+        _packet_capture.open(path);
+        if(!_packet_capture)
+            Logger::error("Could not open packet capture file '" + path + "'");
+        _packet_capture_start = Clock::now();
     });
 }
 
+/**
+ * Append a received command to the running capture (if any), using the trace format of tools/ap_stub_server.
+ * Times are relative to the start of the capture, while the stub server replays them relatively to slot connection.
+ */
+void ArchipelagoInterface::capture_packet(const json& command)
+{
+    if(!_packet_capture.is_open())
+        return;
+
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - _packet_capture_start);
+    _packet_capture << json({ { "time", time.count() }, { "packet", json::array({ command }) } }).dump() << "\n";
+}
+
 void ArchipelagoInterface::say(const std::string& msg)
 {
     if(msg.empty())
         return;
-    if(!_client || _client->get_state() < APClient::State::SOCKET_CONNECTED)
-        return;
 
-    _client->Say(msg);
+    this->post_command([this, msg]() {
+        if(_client && _client->get_state() >= APClient::State::SOCKET_CONNECTED)
+            _client->Say(msg);
+    });
 }
 
 bool ArchipelagoInterface::is_connected() const
 {
-    return _client && _client->get_state() == APClient::State::SLOT_CONNECTED;
+    return _slot_connected;
 }
 
-void ArchipelagoInterface::poll()
+nlohmann::json ArchipelagoInterface::slot_data() const
 {
-    if(!_client)
-        return;
+    std::lock_guard lock(_data_mutex);
+    return _slot_data;
+}
 
-    _client->poll();
+std::shared_ptr<const ScoutedLocations> ArchipelagoInterface::scouted_locations() const
+{
+    std::lock_guard lock(_data_mutex);
+    return _scouted_locations;
 }
 
 void ArchipelagoInterface::send_checked_locations_to_server(const std::vector<int64_t>& checked_locations)
 {
-    if(!_client || _client->get_state() != APClient::State::SLOT_CONNECTED)
-    {
-        Logger::warning("Attempting to send checked locations to server, but there is no connection.");
+    this->post_command([this, checked_locations]() {
+        // Only keep the locations the server doesn't already know about, the others would just be wasted bandwidth
+        std::list<int64_t> locations_to_send;
+        for(int64_t location_id : checked_locations)
+        {
+            if(_acknowledged_locations.contains(location_id))
+                continue;
+            if(_unacknowledged_locations.insert(location_id).second)
+                locations_to_send.emplace_back(location_id);
+        }
+
+        if(_journal && !locations_to_send.empty())
+            _journal->record_checked_locations(std::vector<int64_t>(locations_to_send.begin(), locations_to_send.end()));
+
+        if(!_client || _client->get_state() != APClient::State::SLOT_CONNECTED)
+        {
+            Logger::warning("Attempting to send checked locations to server, but there is no connection. "
+                            "They will be sent upon reconnection.");
+            return;
+        }
+
+        if(!locations_to_send.empty())
+            _client->LocationChecks(locations_to_send);
+    });
+}
+
+/**
+ * Send again all locations which were never acknowledged by the server, typically because connection was lost
+ * while they were in flight.
+ */
+void ArchipelagoInterface::send_unacknowledged_locations()
+{
+    for(int64_t location_id : _acknowledged_locations)
+        _unacknowledged_locations.erase(location_id);
+
+    if(_unacknowledged_locations.empty())
         return;
-    }
 
-    _client->LocationChecks(std::list<int64_t>(checked_locations.begin(), checked_locations.end()));
+    Logger::debug("Resending " + std::to_string(_unacknowledged_locations.size()) + " unacknowledged location checks");
+    _client->LocationChecks(std::list<int64_t>(_unacknowledged_locations.begin(), _unacknowledged_locations.end()));
 }
 
 void ArchipelagoInterface::notify_game_completed()
 {
-    if(!_client || _client->get_state() != APClient::State::SLOT_CONNECTED)
-    {
-        Logger::warning("Attempting to send goal completed, but there is no connection.");
-        return;
-    }
+    this->post_command([this]() {
+        if(!_client || _client->get_state() != APClient::State::SLOT_CONNECTED)
+        {
+            Logger::warning("Attempting to send goal completed, but there is no connection.");
+            return;
+        }
 
-    _client->StatusUpdate(APClient::ClientStatus::GOAL);
+        _client->StatusUpdate(APClient::ClientStatus::GOAL);
+    });
 }
 
 void ArchipelagoInterface::notify_death()
 {
-    if(!_client || _client->get_state() != APClient::State::SLOT_CONNECTED)
-    {
-        Logger::warning("Attempting to send deathlink, but there is no connection.");
-        return;
-    }
+    this->post_command([this]() {
+        if(!_client || _client->get_state() != APClient::State::SLOT_CONNECTED)
+        {
+            Logger::warning("Attempting to send deathlink, but there is no connection.");
+            return;
+        }
 
-    double death_time = _client->get_server_time();
-    json data{
-            {"time", death_time},
-            {"cause", "Wanted to consume an EkeEke."},
-            {"source", _slot_name},
-    };
-    _client->Bounce(data, {}, {}, {"DeathLink"});
-    Logger::debug("Sending death...");
+        double death_time = _client->get_server_time();
+        json data{
+                {"time", death_time},
+                {"cause", "Wanted to consume an EkeEke."},
+                {"source", _slot_name},
+        };
+        _client->Bounce(data, {}, {}, {"DeathLink"});
+        Logger::debug("Sending death...");
+    });
 }
 
-void ArchipelagoInterface::on_socket_connected()
+void ArchipelagoInterface::on_socket_connected(size_t attempt_index)
 {
-    _connected = true;
-    Logger::info("Established connection to Archipelago server.");
+    if(_client || attempt_index >= _connection_attempts.size())
+        return;
+    Logger::info("Established connection to Archipelago server using '" + _connection_attempts[attempt_index].uri + "'.");
 }
 
 void ArchipelagoInterface::on_socket_disconnected()
 {
+    _slot_connected = false;
     _connection_failed = true;
     Logger::error("Disconnected from Archipelago server.");
 }
 
-void ArchipelagoInterface::on_room_info()
+void ArchipelagoInterface::on_socket_error(size_t attempt_index, const std::string& error)
 {
-    if(!_client)
+    // Only racing attempts give up on errors, a lone attempt keeps retrying like APClient always does
+    if(_client || _connection_attempts.size() < 2 || attempt_index >= _connection_attempts.size())
         return;
 
-    _client->ConnectSlot(_slot_name, _password, 5, {}, {0, 6, 0});
+    ConnectionAttempt& attempt = _connection_attempts[attempt_index];
+    Logger::debug("Connection attempt using '" + attempt.uri + "' failed" + (error.empty() ? "" : ": " + error));
+    attempt.failed = true;
+}
+
+void ArchipelagoInterface::on_room_info(APClient* client)
+{
+    client->ConnectSlot(_slot_name, _password, 5, {}, {0, 6, 0});
 }
 
 void ArchipelagoInterface::on_slot_connected(const json& slot_data)
@@ -150,20 +512,43 @@ void ArchipelagoInterface::on_slot_connected(const json& slot_data)
         return;
 
     Logger::info("Connected to slot.");
-    _slot_data = slot_data;
+    this->on_players_changed();
+    {
+        std::lock_guard lock(_data_mutex);
+        _slot_data = slot_data;
+    }
 
-    game_state.has_deathlink(slot_data["death_link"] == 1);
-    if (game_state.has_deathlink())
+    _has_deathlink = (slot_data["death_link"] == 1);
+    if (_has_deathlink)
     {
         Logger::debug("Updating connection with DeathLink tag");
         _client->ConnectUpdate(false, 0, true, { "DeathLink" });
     }
 
-    // Update the expected seed to know which filename to look for during ROM existence check
-    game_state.expected_seed(_slot_data["seed"]);
-    check_rom_existence(game_state.expected_seed(), _slot_name);
+    // Notify the game about the expected seed, which is also used to know which ROM filename to look for
+    SessionEvent event { .type = SessionEvent::Type::SLOT_CONNECTED };
+    event.seed = slot_data["seed"];
+    event.has_deathlink = _has_deathlink;
+    event.player_name = _slot_name;
+    _slot_connected = true;
+    this->push_event(event);
+
+    bool has_scouted_data = this->restore_from_journal(event.seed);
+
+    // Upon connection, the server gives the full list of locations it knows as checked for this slot. This is the
+    // only place where checks are reconciled with the server: RoomUpdate packets never report our own checks, since
+    // the APClient already considers them checked as soon as they are sent.
+    const std::set<int64_t> server_checked_locations = _client->get_checked_locations();
+    _acknowledged_locations.insert(server_checked_locations.begin(), server_checked_locations.end());
+    _journal->record_acknowledged_locations(std::vector<int64_t>(server_checked_locations.begin(),
+                                                                 server_checked_locations.end()));
+    this->send_unacknowledged_locations();
+
+    // Contents of locations never change during a seed, no need to ask the server again if they were journaled
+    if(has_scouted_data)
+        return;
 
-    bool goal_reach_kazalt = (_slot_data["goal"] == 1);
+    bool goal_reach_kazalt = (slot_data["goal"] == 1);
     const std::vector<int64_t> ENDGAME_IDS = {
         4019, 4020, 4021, 4108, 4109, 4110, 4111, 4112, 4113, 4114, 4115, 4116, 4117, 4118, 4119, 4120, 4121,
         4122, 4123, 4124, 4125, 4126, 4127, 4128, 4129, 4130, 4131, 4132, 4133, 4261, 4263, 4265, 4267, 4271,
@@ -182,8 +567,45 @@ void ArchipelagoInterface::on_slot_connected(const json& slot_data)
     _client->LocationScouts(all_location_ids);
 }
 
+/**
+ * Open the journal of the session for given seed, and restore everything it contains: received items are
+ * transmitted to the game right away, and checks that were never acknowledged are queued to be sent again.
+ * @return true if contents of all locations could be restored, meaning there is no need to scout them
+ */
+bool ArchipelagoInterface::restore_from_journal(uint32_t seed)
+{
+    _journal.reset();
+    _journal = std::make_unique<SessionJournal>(SessionJournal::journal_path(seed, _slot_name));
+
+    for(const auto& [index, item] : _journal->received_items())
+    {
+        SessionEvent event { .type = SessionEvent::Type::ITEM_RECEIVED };
+        event.item_index = static_cast<uint16_t>(index);
+        event.item_id = static_cast<uint8_t>(item.item - ITEM_BASE_ID);
+        this->push_event(event);
+    }
+
+    _unacknowledged_locations.insert(_journal->pending_locations().begin(), _journal->pending_locations().end());
+
+    if(_journal->scouted_locations().empty())
+        return false;
+
+    auto scouted_locations = std::make_shared<ScoutedLocations>();
+    scouted_locations->reserve(_journal->scouted_locations().size());
+    for(const SessionJournal::ScoutedLocation& location : _journal->scouted_locations())
+    {
+        scouted_locations->add(location.location, location.location_name, location.item, location.item_name,
+                               location.player, location.player_name);
+    }
+
+    std::lock_guard lock(_data_mutex);
+    _scouted_locations = std::move(scouted_locations);
+    return true;
+}
+
 void ArchipelagoInterface::on_slot_disconnected()
 {
+    _slot_connected = false;
     std::cout << "Disconnected from slot." << std::endl;
 }
 
@@ -202,40 +624,61 @@ void ArchipelagoInterface::on_slot_refused(const std::list<std::string>& errors)
     }
 }
 
-void ArchipelagoInterface::on_item_received(int index, int64_t item, int player, int64_t location)
+void ArchipelagoInterface::on_players_changed()
 {
-    if(!_client)
-        return;
-
-    std::string item_name = _client->get_item_name(item, GAME_NAME);
-    std::string player_name = _client->get_player_alias(player);
-    std::string location_game = _client->get_player_game(player);
-    std::string location_name = _client->get_location_name(location, location_game);
-
-    Logger::debug("Received " + item_name + " from " + player_name + " (" + location_name + ")");
-    game_state.set_received_item(index, item - ITEM_BASE_ID);
+    std::vector<DataPackageLookup::PlayerInfo> players;
+    for(const APClient::NetworkPlayer& player : _client->get_players())
+    {
+        if(player.team != _client->get_team_number())
+            continue;
+
+        players.emplace_back(DataPackageLookup::PlayerInfo {
+            .slot = player.slot,
+            .alias = player.alias,
+            .name = player.name,
+            .game = _client->get_player_game(player.slot)
+        });
+    }
+    _names.set_players(std::move(players));
 }
 
-void ArchipelagoInterface::on_item_scouted(int index, int64_t item, int player, int64_t location)
+void ArchipelagoInterface::on_item_received(int index, int64_t item, int player, int64_t location)
 {
     if(!_client)
         return;
 
-    std::string location_name = _client->get_location_name(location, GAME_NAME);
+    // Items already restored from the journal were already transmitted to the game, only newer ones matter
+    SessionJournal::ReceivedItem received_item { .item = item, .player = player, .location = location };
+    if(_journal && !_journal->record_received_item(index, received_item))
+        return;
 
-    std::string player_name = _client->get_player_alias(player);
-    std::string item_game = _client->get_player_game(player);
-    std::string item_name = _client->get_item_name(item, item_game);
+#ifdef DEBUG
+    std::string message = "Received ";
+    message += _names.item_name(item, GAME_NAME);
+    message += " from ";
+    message += _names.player_alias(player);
+    message += " (";
+    message += _names.location_name(location, player);
+    message += ")";
+    Logger::debug(message);
+#endif
+
+    SessionEvent event { .type = SessionEvent::Type::ITEM_RECEIVED };
+    event.item_index = static_cast<uint16_t>(index);
+    event.item_id = static_cast<uint8_t>(item - ITEM_BASE_ID);
+    this->push_event(event);
+}
 
-    _locations_data[location_name] = {
-            { "item", item_name },
-            { "player", player_name }
-    };
+void ArchipelagoInterface::on_item_scouted(ScoutedLocations& scouted_locations, int64_t item, int player, int64_t location)
+{
+    scouted_locations.add(location, _names.location_name(location, GAME_NAME),
+                          item, _names.item_name(item, player),
+                          player, _names.player_name(player));
 }
 
 void ArchipelagoInterface::on_bounced(const json& packet)
 {
-    if(!game_state.has_deathlink())
+    if(!_has_deathlink)
         return;
 
     auto tagsIt = packet.find("tags");
@@ -259,7 +702,7 @@ void ArchipelagoInterface::on_bounced(const json& packet)
                 Logger::message("Died by the hands of " + player_name + ".");
             }
 
-            game_state.received_death(true);
+            this->push_event(SessionEvent { .type = SessionEvent::Type::DEATH_RECEIVED });
         }
         else
         {
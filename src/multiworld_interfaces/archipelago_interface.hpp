@@ -1,28 +1,98 @@
 #pragma once
 
 #include "multiworld_interface.hpp"
+#include "datapackage_lookup.hpp"
+#include "session_journal.hpp"
 #include "../preset_builder.hpp"
+#include "../scouted_locations.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <condition_variable>
+#include <fstream>
+#include <list>
+#include <mutex>
 #include <set>
+#include <thread>
+#include <vector>
 
 using nlohmann::json;
 
 class APClient;
+class BinaryDataPackageStore;
 
+/**
+ * Multiworld interface talking to an Archipelago server.
+ *
+ * The APClient is exclusively owned by a dedicated network thread which pumps the websocket as soon as something
+ * has to be sent, or a few milliseconds after the previous poll otherwise. Other threads never touch the APClient
+ * directly: they post commands to the network thread, and receive events through the `events()` queue.
+ *
+ * When the host is given without a scheme, the network thread races a `wss://` and a `ws://` connection attempt
+ * (each one with its own APClient). The first one to be connected to its slot becomes the session's client and
+ * the other one is dropped right away. The winning scheme is remembered for this host, and tried first next time.
+ */
 class ArchipelagoInterface : public MultiworldInterface {
 private:
+    using Clock = std::chrono::steady_clock;
+
+    struct ConnectionAttempt
+    {
+        std::string uri;
+        /// Head start given to the attempts before this one, after which this one is started as well
+        std::chrono::milliseconds start_delay;
+        APClient* client = nullptr;
+        bool failed = false;
+    };
+
+    /// Client of the session, only set once a connection attempt is connected to its slot
     APClient* _client = nullptr;
-    bool _connected = false;
-    bool _connection_failed = false;
+    /// Connection attempts competing to become the session's client, emptied as soon as one of them wins
+    std::vector<ConnectionAttempt> _connection_attempts;
+    std::string _host;
+    std::string _uuid;
+    Clock::time_point _connection_start;
+
+    BinaryDataPackageStore* _datapackage_store = nullptr;
+    /// Item, location and player names, only used from the network thread
+    DataPackageLookup _names;
+    std::atomic<bool> _slot_connected = false;
+    std::atomic<bool> _connection_failed = false;
+    bool _has_deathlink = false;
     std::string _slot_name;
     std::string _password;
+
+    /// Data received from the server, which is read by the UI thread when building the ROM
     nlohmann::json _slot_data;
-    nlohmann::json _locations_data;
+    std::shared_ptr<const ScoutedLocations> _scouted_locations;
+    mutable std::mutex _data_mutex;
+
+    /// Locations the server reported as checked in the `Connected` packet
+    std::set<int64_t> _acknowledged_locations;
+    /// Locations that were checked in-game but not acknowledged by the server yet. Interface is destroyed when the
+    /// connection is lost, so checks still pending from a previous connection come from the session journal.
+    std::set<int64_t> _unacknowledged_locations;
+
+    /// Journal of the current (seed, slot) session, opened upon slot connection
+    std::unique_ptr<SessionJournal> _journal;
+
+    /// File received packets are written into while a capture is running (see `capture_packets()`)
+    std::ofstream _packet_capture;
+    Clock::time_point _packet_capture_start;
+
+    /// Commands posted by other threads, to be run by the network thread using the APClient
+    MpscQueue<std::function<void()>> _commands;
+    bool _has_pending_commands = false;
+    bool _stopped = false;
+    std::mutex _network_mutex;
+    std::condition_variable _network_condition;
+    std::thread _network_thread;
 
 public:
-    explicit ArchipelagoInterface(const std::string& uri, std::string slot_name, std::string password);
+    explicit ArchipelagoInterface(const std::string& host, std::string slot_name, std::string password,
+                                  std::function<void()> event_handler = nullptr);
     ~ArchipelagoInterface() override;
 
-    void poll() override;
     void send_checked_locations_to_server(const std::vector<int64_t>& checked_locations) override;
     void say(const std::string& msg) override;
     void notify_game_completed() override;
@@ -32,19 +102,36 @@ public:
     [[nodiscard]] bool is_offline_session() const override { return false; }
     [[nodiscard]] bool connection_failed() const override { return _connection_failed; }
     [[nodiscard]] std::string player_name() const override { return _slot_name; }
-    [[nodiscard]] const nlohmann::json& slot_data() const { return _slot_data; }
-    [[nodiscard]] const nlohmann::json& locations_data() const { return _locations_data; }
+    [[nodiscard]] nlohmann::json slot_data() const;
+    /// @return the contents of all locations of the slot, or nullptr if the server did not send them yet
+    [[nodiscard]] std::shared_ptr<const ScoutedLocations> scouted_locations() const;
+
+    /**
+     * Write received packets into given file from now on, as a trace that tools/ap_stub_server can replay with
+     * `--replay`. Only packets the stub server can't generate by itself are captured (PrintJSON, ReceivedItems and
+     * Bounced). Passing an empty path stops the capture.
+     */
+    void capture_packets(const std::string& path);
 
 private:
-    void init_handlers();
+    void init_handlers(APClient* client, size_t attempt_index);
+    void run_network_thread();
+    void update_connection_attempts();
+    void promote_connection_attempt(size_t attempt_index);
+    void post_command(std::function<void()> command);
+    void capture_packet(const json& command);
+    void send_unacknowledged_locations();
+    bool restore_from_journal(uint32_t seed);
 
-    void on_socket_connected();
+    void on_socket_connected(size_t attempt_index);
     void on_socket_disconnected();
-    void on_room_info();
+    void on_socket_error(size_t attempt_index, const std::string& error);
+    void on_room_info(APClient* client);
     void on_slot_connected(const json& slot_data);
     void on_slot_disconnected();
+    void on_players_changed();
     void on_slot_refused(const std::list<std::string>& errors);
     void on_item_received(int index, int64_t item, int player, int64_t location);
-    void on_item_scouted(int index, int64_t item, int player, int64_t location);
+    void on_item_scouted(ScoutedLocations& scouted_locations, int64_t item, int player, int64_t location);
     void on_bounced(const json& cmd);
 };
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include "binary_datapackage_store.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "../logger.hpp"
+
+constexpr char MAGIC[4] = { 'R', 'S', 'D', 'P' };
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t GAME_ENTRY_SIZE = 32;
+
+template<typename T>
+static bool read_value(const MappedFile& file, uint64_t offset, T& value)
+{
+    if(offset > file.size() || file.size() - offset < sizeof(T))
+        return false;
+    std::memcpy(&value, file.data() + offset, sizeof(T));
+    return true;
+}
+
+template<typename T>
+static void write_value(std::string& buffer, size_t offset, T value)
+{
+    std::memcpy(buffer.data() + offset, &value, sizeof(T));
+}
+
+template<typename T>
+static void append_value(std::string& buffer, T value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/// Append given table at the end of the buffer (aligned on 8 bytes), and return the offset where it was put
+static uint64_t append_table(std::string& buffer, const NameTable& table)
+{
+    buffer.resize((buffer.size() + 7) & ~size_t(7), '\0');
+    uint64_t offset = buffer.size();
+
+    append_value<uint32_t>(buffer, static_cast<uint32_t>(table.size()));
+    append_value<uint32_t>(buffer, static_cast<uint32_t>(table.string_pool().size()));
+    buffer.append(reinterpret_cast<const char*>(table.ids().data()), table.ids().size() * sizeof(int64_t));
+    buffer.append(reinterpret_cast<const char*>(table.name_offsets().data()), table.name_offsets().size() * sizeof(uint32_t));
+    buffer.append(table.string_pool());
+    return offset;
+}
+
+// =====================================================================================================
+
+BinaryDataPackageStore::BinaryDataPackageStore(std::string path, DataPackageLookup& lookup) :
+    _path   (std::move(path)),
+    _file   (std::make_unique<MappedFile>(_path)),
+    _lookup (lookup)
+{
+    if(!_file->is_open())
+        return;
+
+    uint32_t version = 0;
+    if(_file->size() < HEADER_SIZE || std::memcmp(_file->data(), MAGIC, sizeof(MAGIC)) != 0
+    || !read_value(*_file, 4, version) || version != VERSION)
+    {
+        Logger::debug("Datapackage cache has an invalid format, it will be rebuilt");
+        _file->close();
+    }
+}
+
+BinaryDataPackageStore::~BinaryDataPackageStore()
+{
+    this->flush();
+}
+
+bool BinaryDataPackageStore::load(const std::string& game, const std::string& checksum, json& data)
+{
+    // Without a checksum, there is no way to tell if cached data is still up to date
+    if(checksum.empty())
+        return false;
+
+    std::optional<GameEntry> entry = this->find_game(game);
+    if(!entry || this->file_string(entry->checksum_offset, entry->checksum_size) != checksum)
+        return false;
+
+    std::optional<NameTable> items = this->read_table(entry->items_offset);
+    std::optional<NameTable> locations = this->read_table(entry->locations_offset);
+    if(!items || !locations)
+        return false;
+
+    _lookup.add_game(game, std::move(*items), std::move(*locations));
+    data = {
+        { "checksum", checksum },
+        { "item_name_to_id", json::object() },
+        { "location_name_to_id", json::object() }
+    };
+    return true;
+}
+
+bool BinaryDataPackageStore::save(const std::string& game, const json& data)
+{
+    if(!data.is_object())
+        return false;
+
+    NameTable items(data.value("item_name_to_id", json::object()));
+    NameTable locations(data.value("location_name_to_id", json::object()));
+    _lookup.add_game(game, items, locations);
+
+    std::string checksum = data.value("checksum", "");
+    if(checksum.empty())
+        return false;
+
+    _pending_games[game] = GameTables {
+        .checksum = std::move(checksum),
+        .items = std::move(items),
+        .locations = std::move(locations)
+    };
+    return true;
+}
+
+void BinaryDataPackageStore::flush()
+{
+    if(_pending_games.empty())
+        return;
+
+    // Rebuild the whole file with the games it already contained, unless a newer version of them was received
+    std::map<std::string, GameTables> games;
+    for(uint32_t i=0 ; i<this->game_count() ; ++i)
+    {
+        std::optional<GameEntry> entry = this->game_entry(i);
+        if(!entry)
+            break;
+
+        std::string name(this->file_string(entry->name_offset, entry->name_size));
+        if(name.empty() || _pending_games.contains(name))
+            continue;
+
+        std::optional<NameTable> items = this->read_table(entry->items_offset);
+        std::optional<NameTable> locations = this->read_table(entry->locations_offset);
+        if(!items || !locations)
+            continue;
+
+        games[name] = GameTables {
+            .checksum = std::string(this->file_string(entry->checksum_offset, entry->checksum_size)),
+            .items = std::move(*items),
+            .locations = std::move(*locations)
+        };
+    }
+    for(auto& [name, tables] : _pending_games)
+        games[name] = std::move(tables);
+    _pending_games.clear();
+
+    std::string buffer(HEADER_SIZE + games.size() * GAME_ENTRY_SIZE, '\0');
+    std::memcpy(buffer.data(), MAGIC, sizeof(MAGIC));
+    write_value<uint32_t>(buffer, 4, VERSION);
+    write_value<uint32_t>(buffer, 8, static_cast<uint32_t>(games.size()));
+
+    size_t entry_offset = HEADER_SIZE;
+    for(const auto& [name, tables] : games)
+    {
+        write_value<uint32_t>(buffer, entry_offset, static_cast<uint32_t>(buffer.size()));
+        write_value<uint32_t>(buffer, entry_offset + 4, static_cast<uint32_t>(name.size()));
+        buffer += name;
+        write_value<uint32_t>(buffer, entry_offset + 8, static_cast<uint32_t>(buffer.size()));
+        write_value<uint32_t>(buffer, entry_offset + 12, static_cast<uint32_t>(tables.checksum.size()));
+        buffer += tables.checksum;
+        write_value<uint64_t>(buffer, entry_offset + 16, append_table(buffer, tables.items));
+        write_value<uint64_t>(buffer, entry_offset + 24, append_table(buffer, tables.locations));
+        entry_offset += GAME_ENTRY_SIZE;
+    }
+
+    // File is written next to the current one then swapped, so that a crash cannot leave a truncated cache behind.
+    // Racing connection attempts all share the interface's single store, which is only flushed from its network
+    // thread, so there is never more than one writer.
+    std::string temp_path = _path + ".tmp";
+    {
+        std::ofstream temp_file(temp_path, std::ios::binary);
+        temp_file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if(!temp_file)
+        {
+            Logger::warning("Could not write datapackage cache to '" + temp_path + "'");
+            return;
+        }
+    }
+
+    _file->close();
+    std::error_code error;
+    std::filesystem::rename(temp_path, _path, error);
+    if(error)
+        Logger::warning("Could not replace datapackage cache '" + _path + "': " + error.message());
+    _file = std::make_unique<MappedFile>(_path);
+}
+
+uint32_t BinaryDataPackageStore::game_count() const
+{
+    uint32_t count = 0;
+    if(!_file->is_open() || !read_value(*_file, 8, count))
+        return 0;
+    return count;
+}
+
+std::optional<BinaryDataPackageStore::GameEntry> BinaryDataPackageStore::game_entry(uint32_t index) const
+{
+    uint64_t offset = HEADER_SIZE + static_cast<uint64_t>(index) * GAME_ENTRY_SIZE;
+
+    GameEntry entry {};
+    if(!read_value(*_file, offset, entry.name_offset)
+    || !read_value(*_file, offset + 4, entry.name_size)
+    || !read_value(*_file, offset + 8, entry.checksum_offset)
+    || !read_value(*_file, offset + 12, entry.checksum_size)
+    || !read_value(*_file, offset + 16, entry.items_offset)
+    || !read_value(*_file, offset + 24, entry.locations_offset))
+        return std::nullopt;
+    return entry;
+}
+
+std::string_view BinaryDataPackageStore::file_string(uint32_t offset, uint32_t size) const
+{
+    if(offset > _file->size() || _file->size() - offset < size)
+        return {};
+    return { reinterpret_cast<const char*>(_file->data()) + offset, size };
+}
+
+std::optional<BinaryDataPackageStore::GameEntry> BinaryDataPackageStore::find_game(std::string_view game) const
+{
+    // Directory is sorted by game name
+    uint32_t low = 0;
+    uint32_t high = this->game_count();
+    while(low < high)
+    {
+        uint32_t middle = low + (high - low) / 2;
+        std::optional<GameEntry> entry = this->game_entry(middle);
+        if(!entry)
+            return std::nullopt;
+
+        std::string_view name = this->file_string(entry->name_offset, entry->name_size);
+        if(name == game)
+            return entry;
+        else if(name < game)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return std::nullopt;
+}
+
+std::optional<NameTable> BinaryDataPackageStore::read_table(uint64_t offset) const
+{
+    uint32_t count = 0;
+    uint32_t pool_size = 0;
+    if(!read_value(*_file, offset, count) || !read_value(*_file, offset + 4, pool_size))
+        return std::nullopt;
+
+    uint64_t ids_offset = offset + 8;
+    uint64_t name_offsets_offset = ids_offset + static_cast<uint64_t>(count) * sizeof(int64_t);
+    uint64_t pool_offset = name_offsets_offset + (static_cast<uint64_t>(count) + 1) * sizeof(uint32_t);
+    if(pool_offset > _file->size() || _file->size() - pool_offset < pool_size)
+        return std::nullopt;
+
+    std::vector<int64_t> ids(count);
+    if(count > 0)
+        std::memcpy(ids.data(), _file->data() + ids_offset, count * sizeof(int64_t));
+    std::vector<uint32_t> name_offsets(count + 1);
+    std::memcpy(name_offsets.data(), _file->data() + name_offsets_offset, (count + 1) * sizeof(uint32_t));
+
+    // Make sure the table cannot point outside of its string pool
+    for(uint32_t i=0 ; i<count ; ++i)
+        if(name_offsets[i] > name_offsets[i+1])
+            return std::nullopt;
+    if(name_offsets[count] != pool_size)
+        return std::nullopt;
+
+    std::string pool(reinterpret_cast<const char*>(_file->data()) + pool_offset, pool_size);
+    return NameTable(std::move(ids), std::move(name_offsets), std::move(pool));
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <optional>
+#include "apclient.hpp"
+#include "datapackage_lookup.hpp"
+#include "../mapped_file.hpp"
+
+/**
+ * Datapackage store keeping the name tables of every game in a single binary file, which is memory-mapped
+ * instead of being parsed. Only the games present in the room are read from it (when APClient asks for them),
+ * directly into the DataPackageLookup, so connecting does not depend on the total size of the cache.
+ *
+ * Since names are only ever resolved through the DataPackageLookup, APClient is only given a placeholder
+ * datapackage containing the checksum, which is enough for it to consider its cache up to date.
+ *
+ * File starts with the 4 bytes "RSDP", the format version (4 bytes) and the game count (4 bytes), padded to
+ * 16 bytes. Then comes one directory entry per game, sorted by game name (see GameEntry). Each table
+ * is aligned on 8 bytes and made of its name count (4 bytes), its string pool size (4 bytes), sorted ids
+ * (8 bytes each), name offsets inside the pool (4 bytes each, plus one for the end of the last name) and
+ * finally the string pool itself. All values are stored little-endian.
+ */
+class BinaryDataPackageStore : public APDataPackageStore
+{
+private:
+    struct GameEntry
+    {
+        uint32_t name_offset;
+        uint32_t name_size;
+        uint32_t checksum_offset;
+        uint32_t checksum_size;
+        uint64_t items_offset;
+        uint64_t locations_offset;
+    };
+
+    struct GameTables
+    {
+        std::string checksum;
+        NameTable items;
+        NameTable locations;
+    };
+
+    std::string _path;
+    std::unique_ptr<MappedFile> _file;
+    DataPackageLookup& _lookup;
+    /// Games received from the server which were not written to the file yet
+    std::map<std::string, GameTables> _pending_games;
+
+public:
+    BinaryDataPackageStore(std::string path, DataPackageLookup& lookup);
+    ~BinaryDataPackageStore() override;
+
+    bool load(const std::string& game, const std::string& checksum, json& data) override;
+    bool save(const std::string& game, const json& data) override;
+
+    /// Write games received since last flush to the file, along with the ones it already contained
+    void flush();
+
+private:
+    [[nodiscard]] uint32_t game_count() const;
+    [[nodiscard]] std::optional<GameEntry> game_entry(uint32_t index) const;
+    [[nodiscard]] std::string_view file_string(uint32_t offset, uint32_t size) const;
+    [[nodiscard]] std::optional<GameEntry> find_game(std::string_view game) const;
+    [[nodiscard]] std::optional<NameTable> read_table(uint64_t offset) const;
+};
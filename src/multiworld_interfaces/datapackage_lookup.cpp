@@ -0,0 +1,163 @@
+#include "datapackage_lookup.hpp"
+
+#include <algorithm>
+
+/// Name returned for anything that cannot be resolved, same as APClient
+static constexpr std::string_view UNKNOWN_NAME = "Unknown";
+
+NameTable::NameTable(const nlohmann::json& name_to_id)
+{
+    if(!name_to_id.is_object())
+        return;
+
+    std::vector<std::pair<int64_t, std::string_view>> entries;
+    entries.reserve(name_to_id.size());
+    size_t pool_size = 0;
+    for(auto it = name_to_id.begin() ; it != name_to_id.end() ; ++it)
+    {
+        if(!it.value().is_number_integer())
+            continue;
+        entries.emplace_back(it.value().get<int64_t>(), it.key());
+        pool_size += it.key().size();
+    }
+
+    std::sort(entries.begin(), entries.end());
+
+    _ids.reserve(entries.size());
+    _name_offsets.reserve(entries.size() + 1);
+    _string_pool.reserve(pool_size);
+    for(const auto& [id, name] : entries)
+    {
+        _ids.emplace_back(id);
+        _name_offsets.emplace_back(static_cast<uint32_t>(_string_pool.size()));
+        _string_pool += name;
+    }
+    _name_offsets.emplace_back(static_cast<uint32_t>(_string_pool.size()));
+}
+
+NameTable::NameTable(std::vector<int64_t> ids, std::vector<uint32_t> name_offsets, std::string string_pool) :
+    _ids            (std::move(ids)),
+    _name_offsets   (std::move(name_offsets)),
+    _string_pool    (std::move(string_pool))
+{}
+
+std::string_view NameTable::name(int64_t id) const
+{
+    auto it = std::lower_bound(_ids.begin(), _ids.end(), id);
+    if(it == _ids.end() || *it != id)
+        return {};
+
+    size_t index = it - _ids.begin();
+    uint32_t offset = _name_offsets[index];
+    return std::string_view(_string_pool).substr(offset, _name_offsets[index+1] - offset);
+}
+
+// =====================================================================================================
+
+void DataPackageLookup::add_game(const std::string& game, const nlohmann::json& game_data)
+{
+    this->add_game(game, NameTable(game_data.value("item_name_to_id", nlohmann::json::object())),
+                   NameTable(game_data.value("location_name_to_id", nlohmann::json::object())));
+}
+
+void DataPackageLookup::add_game(const std::string& game, NameTable items, NameTable locations)
+{
+    GameTables& tables = _games[game];
+    tables.items = std::move(items);
+    tables.locations = std::move(locations);
+
+    // Map nodes are never removed, so players can keep pointing at their game's tables
+    for(Player& player : _players)
+        if(player.info.game == game)
+            player.tables = &tables;
+}
+
+void DataPackageLookup::set_players(std::vector<PlayerInfo> players)
+{
+    _players.clear();
+    _players.reserve(players.size());
+    for(PlayerInfo& info : players)
+    {
+        const GameTables* tables = this->find_game(info.game);
+        _players.emplace_back(Player { .info = std::move(info), .tables = tables });
+    }
+
+    std::sort(_players.begin(), _players.end(), [](const Player& a, const Player& b) {
+        return a.info.slot < b.info.slot;
+    });
+}
+
+std::string_view DataPackageLookup::item_name(int64_t item_id, std::string_view game) const
+{
+    const GameTables* tables = this->find_game(game);
+    std::string_view name = tables ? tables->items.name(item_id) : std::string_view();
+    return name.empty() ? UNKNOWN_NAME : name;
+}
+
+std::string_view DataPackageLookup::location_name(int64_t location_id, std::string_view game) const
+{
+    const GameTables* tables = this->find_game(game);
+    std::string_view name = tables ? tables->locations.name(location_id) : std::string_view();
+    return name.empty() ? UNKNOWN_NAME : name;
+}
+
+std::string_view DataPackageLookup::item_name(int64_t item_id, int player) const
+{
+    const Player* p = this->find_player(player);
+    std::string_view name = (p && p->tables) ? p->tables->items.name(item_id) : std::string_view();
+    return name.empty() ? UNKNOWN_NAME : name;
+}
+
+std::string_view DataPackageLookup::location_name(int64_t location_id, int player) const
+{
+    // Slot 0 is the server, which can send items from "Archipelago" locations (e.g. starting inventory, cheats)
+    if(player == 0)
+        return this->location_name(location_id, "Archipelago");
+
+    const Player* p = this->find_player(player);
+    std::string_view name = (p && p->tables) ? p->tables->locations.name(location_id) : std::string_view();
+    return name.empty() ? UNKNOWN_NAME : name;
+}
+
+std::string_view DataPackageLookup::player_alias(int player) const
+{
+    if(player == 0)
+        return "Server";
+
+    const Player* p = this->find_player(player);
+    return p ? std::string_view(p->info.alias) : UNKNOWN_NAME;
+}
+
+std::string_view DataPackageLookup::player_name(int player) const
+{
+    if(player == 0)
+        return "Server";
+
+    const Player* p = this->find_player(player);
+    return p ? std::string_view(p->info.name) : UNKNOWN_NAME;
+}
+
+std::string_view DataPackageLookup::player_game(int player) const
+{
+    if(player == 0)
+        return "Archipelago";
+
+    const Player* p = this->find_player(player);
+    return p ? std::string_view(p->info.game) : std::string_view();
+}
+
+const DataPackageLookup::Player* DataPackageLookup::find_player(int player) const
+{
+    auto it = std::lower_bound(_players.begin(), _players.end(), player, [](const Player& p, int slot) {
+        return p.info.slot < slot;
+    });
+    if(it == _players.end() || it->info.slot != player)
+        return nullptr;
+    return &(*it);
+}
+
+const DataPackageLookup::GameTables* DataPackageLookup::find_game(std::string_view game) const
+{
+    auto it = _games.find(game);
+    return (it != _games.end()) ? &it->second : nullptr;
+}
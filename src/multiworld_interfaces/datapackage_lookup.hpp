@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * Compact id -> name table, built once from a "xxx_name_to_id" datapackage object.
+ * Ids are kept sorted in a flat array, and all names are packed into a single string pool, so that looking up
+ * a name is a binary search which doesn't allocate anything.
+ */
+class NameTable
+{
+private:
+    std::vector<int64_t> _ids;
+    /// Offset of each name inside the string pool, with an extra offset marking the end of the last name
+    std::vector<uint32_t> _name_offsets;
+    std::string _string_pool;
+
+public:
+    NameTable() = default;
+    explicit NameTable(const nlohmann::json& name_to_id);
+    NameTable(std::vector<int64_t> ids, std::vector<uint32_t> name_offsets, std::string string_pool);
+
+    /// @return the name associated to given id, or an empty view if there is none
+    [[nodiscard]] std::string_view name(int64_t id) const;
+    [[nodiscard]] size_t size() const { return _ids.size(); }
+
+    [[nodiscard]] const std::vector<int64_t>& ids() const { return _ids; }
+    [[nodiscard]] const std::vector<uint32_t>& name_offsets() const { return _name_offsets; }
+    [[nodiscard]] const std::string& string_pool() const { return _string_pool; }
+};
+
+/**
+ * Resolves item, location and player names for all games of the multiworld without walking any JSON.
+ * Tables are built when the datapackage of a game arrives (either from the server or from the cache), and
+ * when the list of players is received.
+ */
+class DataPackageLookup
+{
+public:
+    struct PlayerInfo
+    {
+        int slot = 0;
+        std::string alias;
+        std::string name;
+        std::string game;
+    };
+
+private:
+    struct GameTables
+    {
+        NameTable items;
+        NameTable locations;
+    };
+
+    struct Player
+    {
+        PlayerInfo info;
+        /// Tables of the game played by this player, or nullptr if its datapackage is not known (yet)
+        const GameTables* tables = nullptr;
+    };
+
+    std::map<std::string, GameTables, std::less<>> _games;
+    /// Players sorted by slot number
+    std::vector<Player> _players;
+
+public:
+    DataPackageLookup() = default;
+
+    void add_game(const std::string& game, const nlohmann::json& game_data);
+    void add_game(const std::string& game, NameTable items, NameTable locations);
+    void set_players(std::vector<PlayerInfo> players);
+
+    [[nodiscard]] std::string_view item_name(int64_t item_id, std::string_view game) const;
+    [[nodiscard]] std::string_view location_name(int64_t location_id, std::string_view game) const;
+
+    /// Item & location names using the game played by given player slot
+    [[nodiscard]] std::string_view item_name(int64_t item_id, int player) const;
+    [[nodiscard]] std::string_view location_name(int64_t location_id, int player) const;
+
+    [[nodiscard]] std::string_view player_alias(int player) const;
+    /// Real name of the player, which doesn't change when an alias is set
+    [[nodiscard]] std::string_view player_name(int player) const;
+    [[nodiscard]] std::string_view player_game(int player) const;
+
+private:
+    [[nodiscard]] const Player* find_player(int player) const;
+    [[nodiscard]] const GameTables* find_game(std::string_view game) const;
+};
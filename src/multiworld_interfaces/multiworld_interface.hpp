@@ -1,15 +1,24 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 #include <string>
+#include "../mpsc_queue.hpp"
+#include "../session_events.hpp"
 
 class MultiworldInterface
 {
+protected:
+    MpscQueue<SessionEvent> _events;
+    /// Called right after an event was pushed, to let the game side know there is something to process
+    std::function<void()> _event_handler;
+
 public:
-    MultiworldInterface() = default;
+    explicit MultiworldInterface(std::function<void()> event_handler = nullptr) :
+        _event_handler(std::move(event_handler))
+    {}
     virtual ~MultiworldInterface() = default;
 
-    virtual void poll() = 0;
     virtual void send_checked_locations_to_server(const std::vector<int64_t>& checked_locations) = 0;
     virtual void say(const std::string& msg) = 0;
 
@@ -20,4 +29,15 @@ public:
 
     virtual void notify_game_completed() = 0;
     virtual void notify_death() = 0;
+
+    /// Events emitted by the multiworld that need to be handled by the game side (received items, deaths...)
+    [[nodiscard]] MpscQueue<SessionEvent>& events() { return _events; }
+
+protected:
+    void push_event(SessionEvent event)
+    {
+        _events.push(std::move(event));
+        if(_event_handler)
+            _event_handler();
+    }
 };
@@ -10,7 +10,6 @@ public:
     OfflinePlayInterface() = default;
     ~OfflinePlayInterface() override = default;
 
-    void poll() override {}
     void send_checked_locations_to_server(const std::vector<int64_t>& checked_locations) override {}
     void say(const std::string& msg) override {}
 
@@ -0,0 +1,341 @@
+#include "session_journal.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "../logger.hpp"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define JOURNALS_DIRECTORY "./journals/"
+
+constexpr char MAGIC[4] = { 'R', 'S', 'J', 'N' };
+constexpr uint8_t VERSION = 1;
+
+/// Compaction happens when the file holds more than twice the records needed to describe the current state
+constexpr size_t COMPACTION_MIN_RECORDS = 256;
+
+enum class RecordType : uint8_t
+{
+    RECEIVED_ITEM = 0,
+    LOCATION_CHECKED = 1,
+    LOCATION_ACKNOWLEDGED = 2,
+    LOCATION_SCOUTED = 3
+};
+
+template<typename T>
+static void append_value(std::string& buffer, T value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void append_string(std::string& buffer, const std::string& str)
+{
+    uint16_t size = static_cast<uint16_t>(std::min<size_t>(str.size(), UINT16_MAX));
+    append_value(buffer, size);
+    buffer.append(str, 0, size);
+}
+
+static void append_received_item(std::string& buffer, int index, const SessionJournal::ReceivedItem& item)
+{
+    append_value(buffer, RecordType::RECEIVED_ITEM);
+    append_value<int32_t>(buffer, index);
+    append_value<int64_t>(buffer, item.item);
+    append_value<int32_t>(buffer, item.player);
+    append_value<int64_t>(buffer, item.location);
+}
+
+static void append_location(std::string& buffer, RecordType type, int64_t location_id)
+{
+    append_value(buffer, type);
+    append_value<int64_t>(buffer, location_id);
+}
+
+static void append_scouted_location(std::string& buffer, const SessionJournal::ScoutedLocation& location)
+{
+    append_value(buffer, RecordType::LOCATION_SCOUTED);
+    append_value<int64_t>(buffer, location.location);
+    append_value<int64_t>(buffer, location.item);
+    append_value<int32_t>(buffer, location.player);
+    append_string(buffer, location.location_name);
+    append_string(buffer, location.item_name);
+    append_string(buffer, location.player_name);
+}
+
+/**
+ * Reads values from a loaded journal, failing (instead of reading past the end) on truncated data
+ */
+class JournalReader
+{
+private:
+    const std::string& _data;
+    size_t _position;
+
+public:
+    JournalReader(const std::string& data, size_t position) : _data(data), _position(position) {}
+
+    template<typename T>
+    bool read(T& value)
+    {
+        if(_data.size() - _position < sizeof(T))
+            return false;
+        std::memcpy(&value, _data.data() + _position, sizeof(T));
+        _position += sizeof(T);
+        return true;
+    }
+
+    bool read_string(std::string& str)
+    {
+        uint16_t size = 0;
+        if(!this->read(size) || _data.size() - _position < size)
+            return false;
+        str.assign(_data, _position, size);
+        _position += size;
+        return true;
+    }
+
+    [[nodiscard]] bool at_end() const { return _position == _data.size(); }
+};
+
+// =====================================================================================================
+
+SessionJournal::SessionJournal(std::string path) :
+    _path(std::move(path))
+{
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(_path).parent_path(), error);
+
+    // A journal which could not be entirely read is rewritten right away, to get rid of its broken tail
+    if(!this->load() && this->compact())
+        return;
+    if(!_file)
+        this->open_for_append();
+}
+
+SessionJournal::~SessionJournal()
+{
+    this->flush(true);
+    if(_file)
+        std::fclose(_file);
+}
+
+bool SessionJournal::load()
+{
+    std::ifstream file(_path, std::ios::binary);
+    if(!file)
+        return false;
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string data = contents.str();
+    if(data.size() < sizeof(MAGIC) + 1 || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0
+    || static_cast<uint8_t>(data[sizeof(MAGIC)]) != VERSION)
+    {
+        Logger::warning("Session journal '" + _path + "' is invalid, it will be rebuilt");
+        return false;
+    }
+
+    JournalReader reader(data, sizeof(MAGIC) + 1);
+    while(!reader.at_end())
+    {
+        RecordType type;
+        if(!reader.read(type))
+            return false;
+
+        if(type == RecordType::RECEIVED_ITEM)
+        {
+            int32_t index = 0;
+            int32_t player = 0;
+            ReceivedItem item;
+            if(!reader.read(index) || !reader.read(item.item) || !reader.read(player) || !reader.read(item.location))
+                return false;
+            item.player = player;
+            _received_items[index] = item;
+        }
+        else if(type == RecordType::LOCATION_CHECKED || type == RecordType::LOCATION_ACKNOWLEDGED)
+        {
+            int64_t location_id = 0;
+            if(!reader.read(location_id))
+                return false;
+            if(type == RecordType::LOCATION_CHECKED)
+                _pending_locations.insert(location_id);
+            else
+                _pending_locations.erase(location_id);
+        }
+        else if(type == RecordType::LOCATION_SCOUTED)
+        {
+            int32_t player = 0;
+            ScoutedLocation location;
+            if(!reader.read(location.location) || !reader.read(location.item) || !reader.read(player)
+            || !reader.read_string(location.location_name) || !reader.read_string(location.item_name)
+            || !reader.read_string(location.player_name))
+                return false;
+            location.player = player;
+            _scouted_locations.emplace_back(std::move(location));
+        }
+        else
+        {
+            Logger::warning("Unknown record found in session journal '" + _path + "'");
+            return false;
+        }
+
+        _record_count += 1;
+    }
+
+    Logger::debug("Restored session journal '" + _path + "' (" + std::to_string(_received_items.size())
+                  + " received items, " + std::to_string(_pending_locations.size()) + " pending checks)");
+    return true;
+}
+
+void SessionJournal::open_for_append()
+{
+    _file = std::fopen(_path.c_str(), "ab");
+    if(!_file)
+        Logger::warning("Could not open session journal '" + _path + "' for writing");
+}
+
+bool SessionJournal::record_received_item(int index, const ReceivedItem& item)
+{
+    auto it = _received_items.find(index);
+    if(it != _received_items.end() && it->second == item)
+        return false;
+
+    _received_items[index] = item;
+    append_received_item(_write_buffer, index, item);
+    _record_count += 1;
+    return true;
+}
+
+void SessionJournal::record_checked_locations(const std::vector<int64_t>& location_ids)
+{
+    for(int64_t location_id : location_ids)
+    {
+        if(!_pending_locations.insert(location_id).second)
+            continue;
+        append_location(_write_buffer, RecordType::LOCATION_CHECKED, location_id);
+        _record_count += 1;
+    }
+
+    // Checks are what the player would lose in a crash, so they don't wait for the end of the flush period
+    this->flush(true);
+}
+
+void SessionJournal::record_acknowledged_locations(const std::vector<int64_t>& location_ids)
+{
+    for(int64_t location_id : location_ids)
+    {
+        if(_pending_locations.erase(location_id) == 0)
+            continue;
+        append_location(_write_buffer, RecordType::LOCATION_ACKNOWLEDGED, location_id);
+        _record_count += 1;
+    }
+}
+
+void SessionJournal::record_scouted_locations(const std::vector<ScoutedLocation>& locations)
+{
+    for(const ScoutedLocation& location : locations)
+    {
+        append_scouted_location(_write_buffer, location);
+        _scouted_locations.emplace_back(location);
+        _record_count += 1;
+    }
+}
+
+void SessionJournal::flush(bool force)
+{
+    if(_write_buffer.empty())
+        return;
+    if(!force && Clock::now() - _last_flush < FLUSH_PERIOD)
+        return;
+
+    size_t live_record_count = _received_items.size() + _pending_locations.size() + _scouted_locations.size();
+    if(_record_count > COMPACTION_MIN_RECORDS && _record_count > live_record_count * 2 && this->compact())
+        return;
+
+    if(_file)
+    {
+        std::fwrite(_write_buffer.data(), 1, _write_buffer.size(), _file);
+        std::fflush(_file);
+#ifdef _WIN32
+        _commit(_fileno(_file));
+#else
+        fsync(fileno(_file));
+#endif
+    }
+    _write_buffer.clear();
+    _last_flush = Clock::now();
+}
+
+/**
+ * Rewrite the whole journal with only the records describing current state, next to the current file and then
+ * swapped with it so that a crash cannot lose anything.
+ * @return true if the journal was rewritten, false if it was kept as is (buffered records are then still pending)
+ */
+bool SessionJournal::compact()
+{
+    std::string contents(MAGIC, sizeof(MAGIC));
+    append_value(contents, VERSION);
+    for(const auto& [index, item] : _received_items)
+        append_received_item(contents, index, item);
+    for(int64_t location_id : _pending_locations)
+        append_location(contents, RecordType::LOCATION_CHECKED, location_id);
+    for(const ScoutedLocation& location : _scouted_locations)
+        append_scouted_location(contents, location);
+
+    if(_file)
+    {
+        std::fclose(_file);
+        _file = nullptr;
+    }
+
+    std::string temp_path = _path + ".tmp";
+    std::FILE* temp_file = std::fopen(temp_path.c_str(), "wb");
+    bool success = false;
+    if(temp_file)
+    {
+        success = (std::fwrite(contents.data(), 1, contents.size(), temp_file) == contents.size());
+        std::fflush(temp_file);
+#ifdef _WIN32
+        _commit(_fileno(temp_file));
+#else
+        fsync(fileno(temp_file));
+#endif
+        std::fclose(temp_file);
+
+        std::error_code error;
+        if(success)
+            std::filesystem::rename(temp_path, _path, error);
+        if(error)
+        {
+            Logger::warning("Could not compact session journal '" + _path + "': " + error.message());
+            success = false;
+        }
+    }
+
+    if(success)
+    {
+        _write_buffer.clear();
+        _record_count = _received_items.size() + _pending_locations.size() + _scouted_locations.size();
+        _last_flush = Clock::now();
+    }
+    this->open_for_append();
+    return success;
+}
+
+std::string SessionJournal::journal_path(uint32_t seed, const std::string& slot_name)
+{
+    // Only keep characters which are safe to use in a filename on every platform
+    std::string safe_slot_name;
+    for(char c : slot_name)
+        safe_slot_name += (std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_') ? c : '_';
+
+    std::ostringstream path;
+    path << JOURNALS_DIRECTORY << std::hex << seed << "_" << safe_slot_name << ".journal";
+    return path.str();
+}
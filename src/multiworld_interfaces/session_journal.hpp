@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * Append-only local journal of everything the server told us (or that we still need to tell the server) for a given
+ * (seed, slot) pair, so that a session can be restored right away after a disconnect or a client restart.
+ *
+ * Records are buffered in memory and written in batches, each batch being synced to disk. When the file contains
+ * too many records that became useless (e.g. pending checks which were acknowledged since), it is compacted by
+ * rewriting only the current state.
+ *
+ * File starts with the 4 bytes "RSJN" followed by the format version (1 byte). Then comes a sequence of records,
+ * each one starting with its type (1 byte), followed by:
+ *  - RECEIVED_ITEM: item index (4 bytes), item id (8 bytes), sending player (4 bytes), location id (8 bytes)
+ *  - LOCATION_CHECKED: location id (8 bytes), checked in-game but not acknowledged by the server yet
+ *  - LOCATION_ACKNOWLEDGED: location id (8 bytes), known as checked by the server
+ *  - LOCATION_SCOUTED: location id (8 bytes), item id (8 bytes), receiving player (4 bytes), then location name,
+ *    item name and player name (each one being its size on 2 bytes followed by its characters)
+ * All values are stored little-endian. A truncated record at the end of the file (crash while writing) is ignored.
+ */
+class SessionJournal
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct ReceivedItem
+    {
+        int64_t item = 0;
+        int player = 0;
+        int64_t location = 0;
+
+        bool operator==(const ReceivedItem&) const = default;
+    };
+
+    struct ScoutedLocation
+    {
+        int64_t location = 0;
+        int64_t item = 0;
+        int player = 0;
+        std::string location_name;
+        std::string item_name;
+        std::string player_name;
+    };
+
+    /// Maximum time a record can stay in memory before being written to disk
+    static constexpr std::chrono::milliseconds FLUSH_PERIOD { 250 };
+
+private:
+    std::string _path;
+    std::FILE* _file = nullptr;
+    std::string _write_buffer;
+    Clock::time_point _last_flush = Clock::now();
+    /// Number of records currently in the file, including the ones which became useless
+    size_t _record_count = 0;
+
+    std::map<int, ReceivedItem> _received_items;
+    std::set<int64_t> _pending_locations;
+    std::vector<ScoutedLocation> _scouted_locations;
+
+public:
+    explicit SessionJournal(std::string path);
+    ~SessionJournal();
+
+    SessionJournal(const SessionJournal&) = delete;
+    SessionJournal& operator=(const SessionJournal&) = delete;
+
+    /// @return false if this exact item was already known with this index, meaning there is nothing new to do
+    bool record_received_item(int index, const ReceivedItem& item);
+    void record_checked_locations(const std::vector<int64_t>& location_ids);
+    void record_acknowledged_locations(const std::vector<int64_t>& location_ids);
+    void record_scouted_locations(const std::vector<ScoutedLocation>& locations);
+
+    /// Write buffered records to disk if the flush period has elapsed (or right away if forced)
+    void flush(bool force = false);
+
+    [[nodiscard]] const std::map<int, ReceivedItem>& received_items() const { return _received_items; }
+    [[nodiscard]] const std::set<int64_t>& pending_locations() const { return _pending_locations; }
+    [[nodiscard]] const std::vector<ScoutedLocation>& scouted_locations() const { return _scouted_locations; }
+
+    /// Path of the journal used for given seed and slot name
+    static std::string journal_path(uint32_t seed, const std::string& slot_name);
+
+private:
+    bool load();
+    bool compact();
+    void open_for_append();
+};
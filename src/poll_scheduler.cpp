@@ -0,0 +1,108 @@
+#include "poll_scheduler.hpp"
+
+#include <algorithm>
+
+PollScheduler::TaskId PollScheduler::add_task(const std::string& name, std::chrono::milliseconds period,
+                                              std::chrono::milliseconds idle_period, uint8_t priority,
+                                              std::function<void()> callback)
+{
+    std::lock_guard lock(_mutex);
+    _tasks.emplace_back(Task {
+        .name = name,
+        .period = period,
+        .idle_period = idle_period,
+        .priority = priority,
+        .callback = std::move(callback),
+        .next_run = Clock::now()
+    });
+    return _tasks.size() - 1;
+}
+
+void PollScheduler::wake(TaskId task_id, std::chrono::milliseconds delay)
+{
+    {
+        std::lock_guard lock(_mutex);
+        if(task_id >= _tasks.size())
+            return;
+        _tasks[task_id].next_run = std::min(_tasks[task_id].next_run, Clock::now() + delay);
+    }
+    _condition.notify_one();
+}
+
+void PollScheduler::idle(bool idle)
+{
+    {
+        std::lock_guard lock(_mutex);
+        if(_idle == idle)
+            return;
+
+        _idle = idle;
+
+        // When leaving idle state, don't wait for the end of long idle periods to start working again
+        if(!_idle)
+        {
+            Clock::time_point now = Clock::now();
+            for(Task& task : _tasks)
+                task.next_run = std::min(task.next_run, now);
+        }
+    }
+    _condition.notify_one();
+}
+
+bool PollScheduler::idle()
+{
+    std::lock_guard lock(_mutex);
+    return _idle;
+}
+
+void PollScheduler::stop()
+{
+    {
+        std::lock_guard lock(_mutex);
+        _stopped = true;
+    }
+    _condition.notify_all();
+}
+
+void PollScheduler::run_pending_tasks()
+{
+    std::vector<TaskId> due_tasks;
+    {
+        std::unique_lock lock(_mutex);
+        if(_tasks.empty())
+            return;
+
+        // Sleep until the next task is due. Since waking a task or leaving idle state can only make a task due
+        // earlier, next due time is recomputed every time the condition is notified.
+        while(!_stopped)
+        {
+            auto next_task = std::min_element(_tasks.begin(), _tasks.end(), [](const Task& a, const Task& b) {
+                return a.next_run < b.next_run;
+            });
+            if(next_task->next_run <= Clock::now())
+                break;
+            _condition.wait_until(lock, next_task->next_run);
+        }
+
+        if(_stopped)
+            return;
+
+        Clock::time_point now = Clock::now();
+        for(TaskId i=0 ; i<_tasks.size() ; ++i)
+        {
+            if(_tasks[i].next_run <= now)
+            {
+                due_tasks.emplace_back(i);
+                _tasks[i].next_run = now + (_idle ? _tasks[i].idle_period : _tasks[i].period);
+            }
+        }
+
+        std::stable_sort(due_tasks.begin(), due_tasks.end(), [this](TaskId a, TaskId b) {
+            return _tasks[a].priority > _tasks[b].priority;
+        });
+    }
+
+    // Callbacks are run without holding the lock, since they are allowed to wake other tasks or change idle state
+    for(TaskId task_id : due_tasks)
+        _tasks[task_id].callback();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Runs a set of periodic tasks from a single thread, each one with its own period and priority.
+ *
+ * Tasks can be woken from any thread to make them run as soon as possible (e.g. when a network event requires
+ * something to be done in-game). When the scheduler is marked as idle (no emulator attached, no save file loaded...),
+ * tasks run using their idle period instead, which is usually much longer.
+ */
+class PollScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using TaskId = size_t;
+
+private:
+    struct Task
+    {
+        std::string name;
+        std::chrono::milliseconds period;
+        std::chrono::milliseconds idle_period;
+        uint8_t priority;
+        std::function<void()> callback;
+        Clock::time_point next_run;
+    };
+
+    std::vector<Task> _tasks;
+    bool _idle = false;
+    bool _stopped = false;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+
+public:
+    PollScheduler() = default;
+
+    /**
+     * Register a new task. Tasks with a higher priority run first when several of them are due at the same time.
+     * All tasks must be registered before calling `run_pending_tasks()`.
+     */
+    TaskId add_task(const std::string& name, std::chrono::milliseconds period, std::chrono::milliseconds idle_period,
+                    uint8_t priority, std::function<void()> callback);
+
+    /// Make given task run after given delay (as soon as possible by default) if it was not due earlier anyway
+    void wake(TaskId task_id, std::chrono::milliseconds delay = std::chrono::milliseconds(0));
+
+    /// Switch tasks to their idle period, or back to their regular period (in which case they are due right away)
+    void idle(bool idle);
+    [[nodiscard]] bool idle();
+
+    /// Make any pending or future call to `run_pending_tasks()` return immediately
+    void stop();
+
+    /// Wait until at least one task is due (or woken), then run all due tasks by order of priority
+    void run_pending_tasks();
+};
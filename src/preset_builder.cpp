@@ -71,50 +71,54 @@ static json build_randomizer_settings_json(const json& slot_data)
     return rando_settings;
 }
 
-static json build_world_json(const json& slot_data, const json& locations_data, const std::string& player_name)
+static json build_world_json(const json& slot_data, const ScoutedLocations& scouted_locations, const std::string& player_name)
 {
     json world = json::object();
 
-    const json& prices = slot_data.at("location_prices");
-
     world["spawnLocation"] = slot_data["spawn_region"];
     world["darkRegion"] = slot_data.at("dark_region");
-    world["itemSources"] = json::object();
 
-    std::map<std::string, json> locations = locations_data;
-    for(auto& [item_source_name, data] : locations)
+    json item_sources = json::object();
+    for(const ScoutedLocations::Entry& entry : scouted_locations.entries())
     {
-        // This is a hacky fix to extract the alias part from the name in cases where slot name fetched from server
-        // looks like "Player Alias (Real Slot Name Causing A Really Long String)".
-        // This was causing textbox overflows in some places, and you really don't want that to happen for the game
-        // to remain stable. Also, aliases were conflicting with the "is it my item" detection to determine if an
-        // item should be a local item or a remote AP item.
-        std::string real_player_name = data["player"];
-        auto pos = real_player_name.find(" (");
-        if (pos != std::string::npos)
-            real_player_name = real_player_name.substr(pos + 2, real_player_name.length() - 1 - (pos+2));
+        std::string_view item_source_name = scouted_locations.name(entry.location_name);
 
         // Ignore the fake "End" location which only serves as a win condition
         if(item_source_name == "End")
             continue;
 
-        std::string item_name = data["item"];
+        // Real player name is used instead of the alias, since aliases can be really long strings which were causing
+        // textbox overflows in some places, and you really don't want that to happen for the game to remain stable.
+        std::string_view real_player_name = scouted_locations.name(entry.player_name);
+        std::string_view item_name = scouted_locations.name(entry.item_name);
+
+        json output = json::object();
         if(real_player_name == player_name)
         {
             if(item_name == "1 Gold")
-                item_name += "s";
+                output["item"] = "1 Golds";
             else if(item_name == "Progressive Armor")
-                item_name = "Steel Breast";
+                output["item"] = "Steel Breast";
+            else
+                output["item"] = item_name;
         }
-
-        json output = { { "item", item_name } };
-        if(prices.contains(item_source_name))
-            output["price"] = prices.at(item_source_name);
-        if(real_player_name != player_name)
+        else
+        {
+            output["item"] = item_name;
             output["player"] = real_player_name;
+        }
+
+        item_sources[std::string(item_source_name)] = std::move(output);
+    }
 
-        world["itemSources"][item_source_name] = output;
+    // Prices are only given for shop locations, which makes it cheaper to go through them than through all locations
+    for(const auto& [item_source_name, price] : slot_data.at("location_prices").items())
+    {
+        auto it = item_sources.find(item_source_name);
+        if(it != item_sources.end())
+            (*it)["price"] = price;
     }
+    world["itemSources"] = std::move(item_sources);
 
     world["teleportTreePairs"] = json::array();
     std::vector<json> pairs = slot_data.at("teleport_tree_pairs");
@@ -126,13 +130,13 @@ static json build_world_json(const json& slot_data, const json& locations_data,
     return world;
 }
 
-json build_preset_json(const json& slot_data, const json& locations_data, const std::string& player_name)
+json build_preset_json(const json& slot_data, const ScoutedLocations& scouted_locations, const std::string& player_name)
 {
     json preset = json::object();
 
     preset["gameSettings"] = build_game_settings_json(slot_data);
     preset["randomizerSettings"] = build_randomizer_settings_json(slot_data);
-    preset["world"] = build_world_json(slot_data, locations_data, player_name);
+    preset["world"] = build_world_json(slot_data, scouted_locations, player_name);
     preset["world"]["seed"] = slot_data["seed"];
 
     return preset;
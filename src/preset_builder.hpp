@@ -1,7 +1,8 @@
 #pragma once
 
 #include <nlohmann/json.hpp>
+#include "scouted_locations.hpp"
 
 using nlohmann::json;
 
-json build_preset_json(const json& slot_data, const json& locations_data, const std::string& player_name);
+json build_preset_json(const json& slot_data, const ScoutedLocations& scouted_locations, const std::string& player_name);
@@ -74,7 +74,7 @@ bool invoke(const std::string& command)
     return ec == 0;
 }
 
-std::set<std::string> invoke_randstalker_to_solve_logic(const std::string& command)
+std::optional<std::set<std::string>> invoke_randstalker_to_solve_logic(const std::string& command)
 {
     STARTUPINFO si;
     ZeroMemory(&si, sizeof(si));
@@ -89,13 +89,13 @@ std::set<std::string> invoke_randstalker_to_solve_logic(const std::string& comma
     if(!CreateProcess(nullptr, command_c_str, nullptr, nullptr, FALSE, PROCESS_FLAGS, nullptr, nullptr, &si, &pi))
     {
         Logger::error("Couldn't update logic for map tracker.");
-        return {};
+        return std::nullopt;
     }
 
     // Wait until child process exits
     WaitForSingleObject(pi.hProcess, INFINITE);
 
-    std::set<std::string> location_names;
+    std::optional<std::set<std::string>> location_names;
 
     DWORD ec;
     GetExitCodeProcess(pi.hProcess, &ec);
@@ -107,8 +107,9 @@ std::set<std::string> invoke_randstalker_to_solve_logic(const std::string& comma
         {
             result_file >> result;
             result_file.close();
+            location_names.emplace();
             for(std::string location_name : result)
-                location_names.insert(location_name);
+                location_names->insert(location_name);
         }
     }
     else
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <optional>
 #include <string>
 #include <set>
 
 bool invoke(const std::string& command);
-std::set<std::string> invoke_randstalker_to_solve_logic(const std::string& command);
\ No newline at end of file
+/// @return the names of all reachable locations, or nothing if randstalker failed to solve logic
+std::optional<std::set<std::string>> invoke_randstalker_to_solve_logic(const std::string& command);
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "reachability_cache.hpp"
+
+#include <fstream>
+#include <sstream>
+
+uint64_t ReachabilityCache::key(const nlohmann::json& preset)
+{
+    // 64-bit FNV-1a over the canonical dump of the preset
+    uint64_t hash = 0xcbf29ce484222325;
+    for(char c : preset.dump())
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+std::optional<ReachabilityCache::Bitset> ReachabilityCache::find(uint64_t key)
+{
+    auto it = _index.find(key);
+    if(it == _index.end())
+        return std::nullopt;
+
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return it->second->reachable;
+}
+
+void ReachabilityCache::insert(uint64_t key, Bitset reachable)
+{
+    auto it = _index.find(key);
+    if(it != _index.end())
+    {
+        it->second->reachable = std::move(reachable);
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return;
+    }
+
+    _entries.push_front(Entry{ key, std::move(reachable) });
+    _index[key] = _entries.begin();
+
+    if(_entries.size() > CAPACITY)
+    {
+        _index.erase(_entries.back().key);
+        _entries.pop_back();
+    }
+}
+
+void ReachabilityCache::clear()
+{
+    _entries.clear();
+    _index.clear();
+}
+
+static std::string bitset_to_hex(const ReachabilityCache::Bitset& bitset)
+{
+    std::vector<uint8_t> nibbles((bitset.size() + 3) / 4, 0);
+    for(size_t i=0 ; i<bitset.size() ; ++i)
+        if(bitset[i])
+            nibbles[i / 4] |= (1 << (i % 4));
+
+    std::string hex;
+    for(uint8_t nibble : nibbles)
+        hex += "0123456789abcdef"[nibble];
+    return hex;
+}
+
+static ReachabilityCache::Bitset hex_to_bitset(const std::string& hex, size_t size)
+{
+    ReachabilityCache::Bitset bitset(size, false);
+    for(size_t i=0 ; i<size && i/4 < hex.size() ; ++i)
+    {
+        char c = hex[i / 4];
+        uint8_t nibble = (c >= 'a') ? (c - 'a' + 10) : (c - '0');
+        bitset[i] = (nibble >> (i % 4)) & 1;
+    }
+    return bitset;
+}
+
+void ReachabilityCache::save_to_file() const
+{
+    if(file_path.empty() || _entries.empty())
+        return;
+
+    nlohmann::json contents = nlohmann::json::object();
+    contents["location_count"] = _location_count;
+    contents["entries"] = nlohmann::json::array();
+    for(const Entry& entry : _entries)
+        contents["entries"].push_back({ { "key", entry.key }, { "reachable", bitset_to_hex(entry.reachable) } });
+
+    std::ofstream file(file_path);
+    file << contents.dump();
+    file.close();
+}
+
+void ReachabilityCache::load_from_file()
+{
+    this->clear();
+    if(file_path.empty())
+        return;
+    std::ifstream file(file_path);
+    if(!file)
+        return;
+
+    try
+    {
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        nlohmann::json contents = nlohmann::json::parse(buffer.str());
+        file.close();
+
+        // Results over another set of locations (e.g. from another client version) are meaningless
+        if(contents["location_count"] != _location_count)
+            return;
+
+        // Entries are stored from the most recently used one, insert them the other way around to keep that order
+        const nlohmann::json& entries = contents["entries"];
+        for(auto it = entries.rbegin() ; it != entries.rend() ; ++it)
+            this->insert((*it)["key"], hex_to_bitset((*it)["reachable"], _location_count));
+    }
+    catch(nlohmann::json::exception&)
+    {
+        this->clear();
+    }
+}
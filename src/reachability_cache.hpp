@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+/**
+ * Least-recently-used cache of map tracker logic results, keyed by a hash of the solve logic preset.
+ *
+ * Presets only contain what matters to logic (tracker settings and owned logic items), and nlohmann::json objects
+ * always dump their keys in the same order, so the dump of a preset is a canonical form of the solver input.
+ * Results are stored as bitsets over location indices (see location_index.hpp).
+ */
+class ReachabilityCache
+{
+public:
+    using Bitset = std::vector<bool>;
+
+private:
+    static constexpr size_t CAPACITY = 512;
+
+    struct Entry
+    {
+        uint64_t key;
+        Bitset reachable;
+    };
+
+    /// Entries from the most recently used to the least recently used one
+    std::list<Entry> _entries;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> _index;
+    size_t _location_count;
+
+public:
+    /// File the cache is persisted in, next to the tracker file of the same seed (no persistence if empty)
+    std::string file_path;
+
+    explicit ReachabilityCache(size_t location_count) : _location_count(location_count) {}
+
+    [[nodiscard]] static uint64_t key(const nlohmann::json& preset);
+
+    [[nodiscard]] std::optional<Bitset> find(uint64_t key);
+    /// Unlike `find()`, doesn't count as a use of the entry
+    [[nodiscard]] bool contains(uint64_t key) const { return _index.contains(key); }
+    void insert(uint64_t key, Bitset reachable);
+    void clear();
+
+    void save_to_file() const;
+    void load_from_file();
+};
@@ -0,0 +1,54 @@
+#include "scouted_locations.hpp"
+
+#include <algorithm>
+
+void ScoutedLocations::reserve(size_t location_count)
+{
+    _entries.reserve(location_count);
+}
+
+void ScoutedLocations::add(int64_t location_id, std::string_view location_name, int64_t item_id,
+                           std::string_view item_name, int player, std::string_view player_name)
+{
+    Entry entry {
+        .location_id = location_id,
+        .item_id = item_id,
+        .player = player,
+        .location_name = this->intern(location_name),
+        .item_name = this->intern(item_name),
+        .player_name = this->intern(player_name)
+    };
+
+    // Server answers are sorted by location id most of the time, making this a simple append
+    auto it = std::lower_bound(_entries.begin(), _entries.end(), location_id, [](const Entry& e, int64_t id) {
+        return e.location_id < id;
+    });
+    if(it != _entries.end() && it->location_id == location_id)
+        *it = entry;
+    else
+        _entries.insert(it, entry);
+}
+
+const ScoutedLocations::Entry* ScoutedLocations::find(int64_t location_id) const
+{
+    auto it = std::lower_bound(_entries.begin(), _entries.end(), location_id, [](const Entry& e, int64_t id) {
+        return e.location_id < id;
+    });
+    if(it == _entries.end() || it->location_id != location_id)
+        return nullptr;
+    return &(*it);
+}
+
+ScoutedLocations::NameRef ScoutedLocations::intern(std::string_view name)
+{
+    size_t hash = std::hash<std::string_view>()(name);
+    auto [begin, end] = _interned_names.equal_range(hash);
+    for(auto it = begin ; it != end ; ++it)
+        if(this->name(it->second) == name)
+            return it->second;
+
+    NameRef ref { .offset = static_cast<uint32_t>(_string_pool.size()), .size = static_cast<uint32_t>(name.size()) };
+    _string_pool += name;
+    _interned_names.emplace(hash, ref);
+    return ref;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Contents of every location of the player's world, as answered by the server to the LocationScouts request
+ * sent upon slot connection. This is what gets placed in item sources when building the ROM.
+ *
+ * Entries are kept sorted by location id, and all names are interned into a single string pool, so that
+ * adding a location doesn't allocate anything most of the time.
+ */
+class ScoutedLocations
+{
+public:
+    /// Position and size of an interned name inside the string pool
+    struct NameRef
+    {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+    };
+
+    struct Entry
+    {
+        int64_t location_id = 0;
+        int64_t item_id = 0;
+        int player = 0;
+        NameRef location_name;
+        NameRef item_name;
+        /// Real name of the player receiving the item (not its alias, which can be much longer)
+        NameRef player_name;
+    };
+
+private:
+    std::vector<Entry> _entries;
+    std::string _string_pool;
+    /// Interned names indexed by hash, only used while adding entries
+    std::unordered_multimap<size_t, NameRef> _interned_names;
+
+public:
+    ScoutedLocations() = default;
+
+    void reserve(size_t location_count);
+    void add(int64_t location_id, std::string_view location_name, int64_t item_id, std::string_view item_name,
+             int player, std::string_view player_name);
+
+    /// @return the entry for given location id, or nullptr if it was not scouted
+    [[nodiscard]] const Entry* find(int64_t location_id) const;
+
+    [[nodiscard]] const std::vector<Entry>& entries() const { return _entries; }
+    [[nodiscard]] bool empty() const { return _entries.empty(); }
+    [[nodiscard]] std::string_view name(NameRef ref) const { return std::string_view(_string_pool).substr(ref.offset, ref.size); }
+
+private:
+    NameRef intern(std::string_view name);
+};
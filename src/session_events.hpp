@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Something that happened on one side of the client (network, game or UI) which needs to be handled by another side.
+ * Events are passed around using MpscQueue, only the fields related to the event type are meaningful.
+ */
+struct SessionEvent
+{
+    enum class Type
+    {
+        SLOT_CONNECTED,         ///< Multiworld -> game & UI: seed, deathlink setting and player name are known
+        ITEM_RECEIVED,          ///< Multiworld -> game: item with given index was received
+        DEATH_RECEIVED,         ///< Multiworld -> game: another player died and deathlink is enabled
+        LOCATIONS_CHECKED,      ///< Game -> multiworld: player checked new locations
+        GOAL_COMPLETED,         ///< Game -> multiworld: player reached their goal
+        PLAYER_DIED,            ///< Game -> multiworld: player died and deathlink is enabled
+        INVENTORY_CHANGED       ///< Game -> UI: inventory changed, tracker logic needs to be updated
+    };
+
+    Type type = Type::ITEM_RECEIVED;
+    /// Time at which the event was emitted, used for latency measurements
+    std::chrono::steady_clock::time_point timestamp = std::chrono::steady_clock::now();
+
+    uint32_t seed = 0;
+    bool has_deathlink = false;
+    std::string player_name {};
+
+    uint16_t item_index = 0;
+    uint8_t item_id = 0;
+
+    std::vector<int64_t> location_ids {};
+};
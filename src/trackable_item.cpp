@@ -1,29 +1,18 @@
 #include "trackable_item.hpp"
 
-TrackableItem::TrackableItem(const nlohmann::json& json)
+TrackableItem::TrackableItem(const TrackableItemDefinition& definition) :
+    _name(definition.name),
+    _item_id(definition.item_id),
+    _quantity(definition.quantity)
 {
     constexpr float ICON_SIZE = 55.f;
 
-    if(json.contains("name"))
-        _name = json.at("name");
-    if(json.contains("image"))
+    if(definition.image[0] != '\0')
     {
-        std::string image_filename = json.at("image");
-        _texture.loadFromFile("images/" + image_filename);
+        _texture.loadFromFile("images/" + std::string(definition.image));
         _texture.setSmooth(true);
     }
-    if(json.contains("itemId"))
-        _item_id = json.at("itemId");
 
-    _quantity = 0;
-    if(json.contains("quantity"))
-        _quantity = json.at("quantity");
-
-    if(json.contains("x"))
-        _x = json.at("x");
-    _x *= ICON_SIZE;
-
-    if(json.contains("y"))
-        _y = json.at("y");
-    _y *= ICON_SIZE;
+    _x = definition.x * ICON_SIZE;
+    _y = definition.y * ICON_SIZE;
 }
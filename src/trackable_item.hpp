@@ -5,7 +5,7 @@
 #include <set>
 #include <SFML/Graphics/Texture.hpp>
 #include <SFML/Graphics/Sprite.hpp>
-#include <nlohmann/json.hpp>
+#include "data_tables.hpp"
 
 class TrackableItem
 {
@@ -18,7 +18,7 @@ private:
     sf::Texture _texture;
 
 public:
-    explicit TrackableItem(const nlohmann::json& json);
+    explicit TrackableItem(const TrackableItemDefinition& definition);
 
     const std::string& name() const { return _name; }
     uint8_t item_id() const { return _item_id; }
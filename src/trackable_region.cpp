@@ -1,45 +1,28 @@
 #include "trackable_region.hpp"
 #include "client.hpp"
 
-TrackableRegion::TrackableRegion(const nlohmann::json& json)
+TrackableRegion::TrackableRegion(const TrackableRegionDefinition& definition, std::span<const uint16_t> location_indices) :
+    _name(definition.name),
+    _x(definition.x),
+    _y(definition.y),
+    _width(definition.width),
+    _height(definition.height),
+    _hidden_for_goals(definition.hidden_for_goals),
+    _dark_dungeon_name(definition.dark_dungeon_name),
+    _spawn_location_name(definition.spawn_location_name),
+    _teleport_tree_name(definition.teleport_tree_name)
 {
-    if(json.contains("name"))
-        _name = json.at("name");
-    if(json.contains("x"))
-        _x = json.at("x");
-    if(json.contains("y"))
-        _y = json.at("y");
-    if(json.contains("width"))
-        _width = json.at("width");
-    if(json.contains("height"))
-        _height = json.at("height");
-    if(json.contains("locations"))
-    {
-        for(std::string loc_name : json.at("locations"))
-        {
-            Location* loc = game_state.location(loc_name);
-            if(loc)
-                _locations.emplace_back(loc);
-        }
-    }
-    if(json.contains("hiddenForGoals"))
-    {
-        for(uint8_t goal_id : json.at("hiddenForGoals"))
-            _hidden_for_goals.insert(goal_id);
-    }
-    if(json.contains("darkDungeonName"))
-        _dark_dungeon_name = json.at("darkDungeonName");
-    if(json.contains("spawnLocationName"))
-        _spawn_location_name = json.at("spawnLocationName");
-    if(json.contains("teleportTreeName"))
-        _teleport_tree_name = json.at("teleportTreeName");
+    _locations.reserve(location_indices.size());
+    for(uint16_t location_index : location_indices)
+        _locations.emplace_back(&game_state.locations()[location_index]);
 }
 
-void TrackableRegion::sort_locations(const std::set<uint16_t>& ignored_locations)
+void TrackableRegion::sort_locations(const std::set<uint16_t>& checked_locations,
+                                     const std::set<uint16_t>& ignored_locations)
 {
-    auto get_location_value = [ignored_locations](const Location* loc) -> uint8_t
+    auto get_location_value = [&checked_locations, &ignored_locations](const Location* loc) -> uint8_t
     {
-        if(loc->was_checked())
+        if(checked_locations.contains(loc->id()))
             return 3;
         else if(ignored_locations.contains(loc->id()))
             return 2;
@@ -55,7 +38,8 @@ void TrackableRegion::sort_locations(const std::set<uint16_t>& ignored_locations
 
         if(a_value != b_value)
             return a_value < b_value;
-        return a->name() < b->name();
+        // Location indices follow the alphabetical order of location names
+        return a->index() < b->index();
     };
 
     std::sort(_locations.begin(), _locations.end(), sorting_func);
@@ -1,9 +1,10 @@
 #pragma once
 
+#include <span>
 #include <string>
 #include <vector>
 #include <set>
-#include <nlohmann/json.hpp>
+#include "data_tables.hpp"
 
 class Location;
 
@@ -16,13 +17,13 @@ private:
     uint16_t _width = 1;
     uint16_t _height = 1;
     std::vector<Location*> _locations;
-    std::set<uint8_t> _hidden_for_goals;
+    uint8_t _hidden_for_goals = 0;
     std::string _dark_dungeon_name = "_";
     std::string _spawn_location_name = "_";
     std::string _teleport_tree_name;
 
 public:
-    explicit TrackableRegion(const nlohmann::json& json);
+    TrackableRegion(const TrackableRegionDefinition& definition, std::span<const uint16_t> location_indices);
 
     [[nodiscard]] const std::string& name() const { return _name; }
     [[nodiscard]] uint16_t x() const { return _x; }
@@ -33,8 +34,8 @@ public:
     [[nodiscard]] const std::string& spawn_location_name() const { return _spawn_location_name; }
     [[nodiscard]] const std::string& teleport_tree_name() const { return _teleport_tree_name; }
 
-    void sort_locations(const std::set<uint16_t>& ignored_locations);
+    void sort_locations(const std::set<uint16_t>& checked_locations, const std::set<uint16_t>& ignored_locations);
     [[nodiscard]] const std::vector<Location*>& locations() const { return _locations; }
 
-    [[nodiscard]] bool is_hidden_for_goal(uint8_t goal_id) const { return _hidden_for_goals.count(goal_id); }
+    [[nodiscard]] bool is_hidden_for_goal(uint8_t goal_id) const { return (_hidden_for_goals >> goal_id) & 1; }
 };
@@ -10,8 +10,9 @@
 #include "user_interface.hpp"
 #include "client.hpp"
 #include "randstalker_invoker.hpp"
-#include "data/trackable_items.json.hxx"
-#include "data/trackable_regions.json.hxx"
+#include "latency_stats.hpp"
+#include "data/trackable_items.hxx"
+#include "data/trackable_regions.hxx"
 
 // ===== WINDOWS SPECIFIC TOOL FUNCTIONS ======================================================================
 
@@ -72,7 +73,7 @@ constexpr uint32_t MAP_TRACKER_WINDOW_MIN_W = 410;
 
 constexpr uint32_t MARGIN = 8;
 constexpr uint32_t LEFT_PANEL_WIDTH = 340;
-constexpr uint32_t STATUS_WINDOW_H = 104;
+constexpr uint32_t STATUS_WINDOW_H = 128;
 
 constexpr uint32_t CONSOLE_INPUT_HEIGHT = 35;
 
@@ -303,6 +304,8 @@ float UserInterface::draw_item_tracker_window() const
     ImGui::SetNextWindowPos(ImVec2(MARGIN, MARGIN));
     ImGui::SetNextWindowSize(ImVec2(LEFT_PANEL_WIDTH, 0.f));
 
+    std::shared_ptr<const GameStateSnapshot> snapshot = game_state.snapshot();
+
     ImGui::Begin("Tracker", nullptr, WINDOW_FLAGS);
     {
         ImVec2 wsize(46.f, 46.f);
@@ -313,7 +316,7 @@ float UserInterface::draw_item_tracker_window() const
                 continue;
 
             uint8_t target_quantity = (item->quantity()) ? item->quantity() : 1;
-            bool item_owned = (game_state.owned_item_quantity(item->item_id()) >= target_quantity);
+            bool item_owned = (snapshot->owned_item_quantity(item->item_id()) >= target_quantity);
             ImVec4 color_multipler(1, 1, 1, 1);
             if(!item_owned)
                 color_multipler = ImVec4(0.4, 0.4, 0.4, 0.6);
@@ -543,6 +546,8 @@ void UserInterface::draw_map_tracker_details_window(float y)
     if(!_selected_region)
         return;
 
+    std::shared_ptr<const GameStateSnapshot> snapshot = game_state.snapshot();
+
     ImGui::SetNextWindowSize(ImVec2(LEFT_PANEL_WIDTH, (float)_window_height - y - STATUS_WINDOW_H - 2*MARGIN));
     ImGui::Begin("Locations details", nullptr, WINDOW_FLAGS);
     {
@@ -603,12 +608,12 @@ void UserInterface::draw_map_tracker_details_window(float y)
 
             // Chest icon
             ImVec4 color_multiplier(1.f, 1.f, 1.f, 1.f);
-            if(loc_ignored && !loc->was_checked())
+            if(loc_ignored && !snapshot->was_checked(*loc))
                 color_multiplier.w = 0.4;
 
             float initial_cursor_y = ImGui::GetCursorPosY();
 
-            sf::Texture* texture = (loc->was_checked()) ? _tex_location_checked : _tex_location;
+            sf::Texture* texture = (snapshot->was_checked(*loc)) ? _tex_location_checked : _tex_location;
             ImTextureID texture_id = (ImTextureID)(uintptr_t)texture->getNativeHandle();
             ImGui::Image(texture_id, ImVec2(39.f, 39.f), ImVec2(0,0), ImVec2(1,1), color_multiplier);
             if (ImGui::IsItemHovered() && ImGui::IsMouseReleased(1))
@@ -618,18 +623,18 @@ void UserInterface::draw_map_tracker_details_window(float y)
             float cursor_y_after_image = ImGui::GetCursorPos().y;
 
             // Location name
-            if(loc_ignored || loc->was_checked())
+            if(loc_ignored || snapshot->was_checked(*loc))
                 ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255,255,255,128));
 
             ImGui::SetCursorPos(ImVec2(cursor_x_after_image, initial_cursor_y));
-            ImGui::TextWrapped("%s", loc->name().c_str());
+            ImGui::TextWrapped("%s", loc->name().data());
 
-            if(loc_ignored || loc->was_checked())
+            if(loc_ignored || snapshot->was_checked(*loc))
                 ImGui::PopStyleColor();
 
             // Location status
             ImGui::SetCursorPosX(cursor_x_after_image);
-            if(loc->was_checked())
+            if(snapshot->was_checked(*loc))
             {
                 ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(100,255,100,128));
                 ImGui::TextWrapped("Already checked");
@@ -656,27 +661,27 @@ void UserInterface::draw_map_tracker_details_window(float y)
 
             ImGui::SetCursorPosX(cursor_x_after_image);
 
-            if(!loc->was_checked())
+            if(!snapshot->was_checked(*loc))
             {
                 if(!multiworld->is_offline_session())
                 {
-                    std::string hint_btn_id = "Hint contents##" + loc->name();
+                    std::string hint_btn_id = "Hint contents##" + std::string(loc->name());
                     if(ImGui::Button(hint_btn_id.c_str()))
-                        process_console_input("!hint_location " + loc->name());
+                        process_console_input("!hint_location " + std::string(loc->name()));
                     ImGui::SameLine();
                 }
 
                 std::string ignore_button_label = loc_ignored ? "Restore" : "Ignore";
-                ignore_button_label += "##" + loc->name();
+                ignore_button_label += "##" + std::string(loc->name());
                 if(ImGui::Button(ignore_button_label.c_str()))
                     _tracker_config.toggle_location_ignored(loc->id());
 
                 if(!loc->url().empty())
                 {
                     ImGui::SameLine();
-                    std::string where_is_it_btn_id = "Where is it?##" + loc->name();
+                    std::string where_is_it_btn_id = "Where is it?##" + std::string(loc->name());
                     if(ImGui::Button(where_is_it_btn_id.c_str()))
-                        ShellExecuteA(nullptr, "open", loc->url().c_str(), nullptr, nullptr, SW_SHOWDEFAULT);
+                        ShellExecuteA(nullptr, "open", loc->url().data(), nullptr, nullptr, SW_SHOWDEFAULT);
                 }
             }
 
@@ -752,6 +757,33 @@ void UserInterface::draw_status_window() const
             ImGui::PopStyleColor();
         }
 
+        ImGui::Separator(); // --------------------------------------------
+
+        LatencyStats::Summary item_latency = LatencyStats::get().summary(LatencyStats::ITEM_RECEIVED_TO_CONSUMED);
+        ImGui::Text("Item latency:");
+        ImGui::SameLine();
+        if(item_latency.window_count > 0)
+            ImGui::Text("%u / %u / %u ms", item_latency.p50, item_latency.p95, item_latency.p99);
+        else
+            ImGui::TextDisabled("No data");
+        if(ImGui::IsItemHovered())
+        {
+            std::string tooltip_text = "Latency percentiles (p50 / p95 / p99) over the last samples:";
+            for(int i=0 ; i<LatencyStats::STAGE_COUNT ; ++i)
+            {
+                auto stage = static_cast<LatencyStats::Stage>(i);
+                LatencyStats::Summary summary = LatencyStats::get().summary(stage);
+                tooltip_text += "\n- " + std::string(LatencyStats::stage_name(stage)) + ": ";
+                if(summary.window_count > 0)
+                    tooltip_text += std::to_string(summary.p50) + " / " + std::to_string(summary.p95) + " / "
+                                  + std::to_string(summary.p99) + " ms";
+                else
+                    tooltip_text += "no data";
+            }
+            tooltip_text += "\n\nUse /latency to export those values to a file.";
+            ImGui::SetTooltip("%s", tooltip_text.c_str());
+        }
+
         ImGui::Separator(); // --------------------------------------------
         ImGui::Dummy(ImVec2(0.f, 1.f));
 
@@ -786,6 +818,8 @@ float UserInterface::draw_map_tracker_window(float x, float y, float width, floa
     if(height != 0.f)
         map_origin_y = std::round((height - map_height) / 2.f);
 
+    std::shared_ptr<const GameStateSnapshot> snapshot = game_state.snapshot();
+
     ImGui::Begin("Map Tracker", &_map_tracker_open, WINDOW_FLAGS & (~ImGuiWindowFlags_NoTitleBar));
     {
         for(TrackableRegion* region : _trackable_regions)
@@ -807,7 +841,7 @@ float UserInterface::draw_map_tracker_window(float x, float y, float width, floa
             uint32_t ignored_count = 0;
             for(const Location* loc : region->locations())
             {
-                if(loc->was_checked())
+                if(snapshot->was_checked(*loc))
                     checked_count += 1;
                 else if(_tracker_config.ignored_locations.contains(loc->id()))
                     ignored_count += 1;
@@ -861,7 +895,7 @@ float UserInterface::draw_map_tracker_window(float x, float y, float width, floa
                     if(_selected_region != region)
                     {
                         _selected_region = region;
-                        _selected_region->sort_locations(_tracker_config.ignored_locations);
+                        _selected_region->sort_locations(snapshot->checked_locations, _tracker_config.ignored_locations);
                     }
                     else
                         _selected_region = nullptr;
@@ -870,7 +904,7 @@ float UserInterface::draw_map_tracker_window(float x, float y, float width, floa
                 if(ImGui::IsMouseReleased(1))
                 {
                     for(Location* loc : region->locations())
-                        if(loc->reachable() && !loc->was_checked())
+                        if(loc->reachable() && !snapshot->was_checked(*loc))
                             _tracker_config.ignored_locations.insert(loc->id());
                 }
             }
@@ -1056,6 +1090,8 @@ void UserInterface::loop(sf::RenderWindow& window)
                 window.setFramerateLimit(FRAMERATE_LIMIT_FOCUS);
         }
 
+        process_ui_events();
+
         window.clear(sf::Color::Black);
         ImGui::SFML::Update(window, delta_clock.restart());
 
@@ -1310,10 +1346,9 @@ void UserInterface::save_client_settings()
 
 void UserInterface::init_item_tracker()
 {
-    json input_json = json::parse(TRACKABLE_ITEMS_JSON);
-    for(json& item_data : input_json)
+    for(const TrackableItemDefinition& item_definition : TRACKABLE_ITEMS)
     {
-        TrackableItem* item = new TrackableItem(item_data);
+        TrackableItem* item = new TrackableItem(item_definition);
         _trackable_items.emplace_back(item);
         if(item->name() == "Lantern")
             _tex_lantern_id = item->get_texture_id();
@@ -1322,9 +1357,12 @@ void UserInterface::init_item_tracker()
 
 void UserInterface::init_map_tracker()
 {
-    json input_json = json::parse(TRACKABLE_REGIONS_JSON);
-    for(json& region_data : input_json)
-        _trackable_regions.emplace_back(new TrackableRegion(region_data));
+    for(const TrackableRegionDefinition& region_definition : TRACKABLE_REGIONS)
+    {
+        std::span<const uint16_t> location_indices(TRACKABLE_REGION_LOCATIONS + region_definition.first_location,
+                                                   region_definition.location_count);
+        _trackable_regions.emplace_back(new TrackableRegion(region_definition, location_indices));
+    }
 
     _tracker_config.init_teleport_trees(_trackable_regions);
 
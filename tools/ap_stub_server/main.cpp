@@ -0,0 +1,85 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include "stub_server.hpp"
+
+static const char* USAGE =
+    "Usage: ap_stub_server [options]\n"
+    "  --port <port>               Port to listen on (default: 38281)\n"
+    "  --game <name>               Game name announced by the server\n"
+    "  --slot-data <file.json>     Slot data sent to the client on connection\n"
+    "  --datapackage <file.json>   Game datapackage (with item_name_to_id and location_name_to_id), generated if absent\n"
+    "  --items <count>             Number of items to send to the client\n"
+    "  --item-rate <per second>    Rate at which items are sent (0 to send them all at once)\n"
+    "  --item-id <id>              Id of the item sent by the item flood (default: 4000, EkeEke)\n"
+    "  --chat <count>              Number of chat / item send messages to send to the client\n"
+    "  --chat-rate <per second>    Rate at which chat messages are sent (0 to send them all at once)\n"
+    "  --deaths <count>            Number of deathlinks to send to the client\n"
+    "  --death-rate <per second>   Rate at which deathlinks are sent (0 to send them all at once)\n"
+    "  --replay <trace.jsonl>      Replay a recorded session trace ({\"time\": ms, \"packet\": [...]} per line),\n"
+    "                              as captured by the client's !recordpackets console command\n"
+    "  --ping-interval <ms>        Interval between latency probes (default: 100)\n"
+    "  --linger <seconds>          Time to wait once everything was sent before stopping (default: 5)\n";
+
+static json read_json_file(const std::string& path)
+{
+    std::ifstream file(path);
+    if(!file)
+        throw std::runtime_error("Could not open '" + path + "'");
+
+    json contents = json::parse(file, nullptr, false);
+    if(contents.is_discarded())
+        throw std::runtime_error("'" + path + "' is not a valid JSON file");
+    return contents;
+}
+
+static StubServerSettings parse_arguments(int argc, char* argv[])
+{
+    StubServerSettings settings;
+    for(int i=1 ; i<argc ; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "--help" || arg == "-h")
+        {
+            std::cout << USAGE;
+            std::exit(0);
+        }
+        if(i+1 >= argc)
+            throw std::runtime_error("Missing value for argument '" + arg + "'");
+
+        std::string value = argv[++i];
+        if(arg == "--port")                 settings.port = static_cast<uint16_t>(std::stoul(value));
+        else if(arg == "--game")            settings.game = value;
+        else if(arg == "--slot-data")       settings.slot_data = read_json_file(value);
+        else if(arg == "--datapackage")     settings.datapackage = read_json_file(value);
+        else if(arg == "--items")           settings.items.count = static_cast<uint32_t>(std::stoul(value));
+        else if(arg == "--item-rate")       settings.items.rate = std::stod(value);
+        else if(arg == "--item-id")         settings.flood_item_id = std::stoll(value);
+        else if(arg == "--chat")            settings.chat.count = static_cast<uint32_t>(std::stoul(value));
+        else if(arg == "--chat-rate")       settings.chat.rate = std::stod(value);
+        else if(arg == "--deaths")          settings.deaths.count = static_cast<uint32_t>(std::stoul(value));
+        else if(arg == "--death-rate")      settings.deaths.rate = std::stod(value);
+        else if(arg == "--replay")          settings.trace_path = value;
+        else if(arg == "--ping-interval")   settings.ping_interval = std::chrono::milliseconds(std::stoul(value));
+        else if(arg == "--linger")          settings.linger_seconds = static_cast<uint32_t>(std::stoul(value));
+        else
+            throw std::runtime_error("Unknown argument '" + arg + "'");
+    }
+    return settings;
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        StubServer server(parse_arguments(argc, argv));
+        server.run();
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n" << USAGE;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,529 @@
+#include "stub_server.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+/// Period at which floods and trace are advanced, and reports are printed
+constexpr long TICK_MILLIS = 5;
+constexpr std::chrono::seconds REPORT_PERIOD { 1 };
+
+constexpr int CLIENT_SLOT = 1;
+constexpr int OTHER_SLOT = 2;
+constexpr const char* OTHER_PLAYER_NAME = "StubPlayer";
+
+/// Ranges used to generate a datapackage when none is given, covering every item and location of the game
+constexpr int64_t ITEM_BASE_ID = 4000;
+constexpr int64_t ITEM_COUNT = 0x40;
+constexpr int64_t LOCATION_BASE_ID = 4000;
+constexpr int64_t LOCATION_COUNT = 500;
+
+static double seconds_since(std::chrono::steady_clock::time_point time)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - time).count();
+}
+
+static json version_json()
+{
+    return { { "major", 0 }, { "minor", 5 }, { "build", 0 }, { "class", "Version" } };
+}
+
+/// @return the given percentile (in milliseconds) of a sorted list of samples in microseconds
+static double percentile(const std::vector<uint32_t>& samples, double ratio)
+{
+    if(samples.empty())
+        return 0.0;
+    size_t index = std::min(samples.size() - 1, static_cast<size_t>(ratio * static_cast<double>(samples.size())));
+    return samples[index] / 1000.0;
+}
+
+// =====================================================================================================
+
+StubServer::StubServer(StubServerSettings settings) :
+    _settings   (std::move(settings)),
+    _items      ({ _settings.items }),
+    _chat       ({ _settings.chat }),
+    _deaths     ({ _settings.deaths })
+{
+    this->build_datapackage();
+    if(!_settings.trace_path.empty())
+        this->load_trace(_settings.trace_path);
+
+    _server.clear_access_channels(websocketpp::log::alevel::all);
+    _server.clear_error_channels(websocketpp::log::elevel::all);
+    _server.set_error_channels(websocketpp::log::elevel::fatal);
+    _server.init_asio();
+    _server.set_reuse_addr(true);
+
+    _server.set_open_handler([this](websocketpp::connection_hdl hdl) { this->on_open(hdl); });
+    _server.set_close_handler([this](websocketpp::connection_hdl hdl) { this->on_close(hdl); });
+    _server.set_message_handler([this](websocketpp::connection_hdl hdl, Server::message_ptr msg) {
+        this->on_message(hdl, msg);
+    });
+    _server.set_pong_handler([this](websocketpp::connection_hdl hdl, const std::string& payload) {
+        this->on_pong(hdl, payload);
+    });
+}
+
+void StubServer::run()
+{
+    _server.listen(_settings.port);
+    _server.start_accept();
+    std::cout << "Stub Archipelago server listening on port " << _settings.port << std::endl;
+
+    _server.set_timer(TICK_MILLIS, [this](const std::error_code& error) { if(!error) this->on_tick(); });
+    _server.run();
+}
+
+/**
+ * Trace files contain one server packet per line, each one being a JSON object with the time (in milliseconds,
+ * relative to the moment the client is connected to its slot) at which it must be sent, and the packet itself:
+ *      {"time": 1500, "packet": [{"cmd": "PrintJSON", ...}]}
+ * Packets are replayed as is, on top of anything the floods are sending. Such traces can be captured from a real
+ * session using the `!recordpackets <path>` console command of a DEBUG build of the client.
+ */
+void StubServer::load_trace(const std::string& path)
+{
+    std::ifstream file(path);
+    if(!file)
+        throw std::runtime_error("Could not open trace file '" + path + "'");
+
+    std::string line;
+    size_t line_number = 0;
+    while(std::getline(file, line))
+    {
+        line_number += 1;
+        if(line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        json entry = json::parse(line, nullptr, false);
+        if(entry.is_discarded() || !entry.is_object() || !entry["time"].is_number() || !entry.contains("packet"))
+            throw std::runtime_error("Invalid trace entry on line " + std::to_string(line_number) + " of '" + path + "'");
+
+        json packet = entry["packet"];
+        if(packet.is_object())
+            packet = json::array({ packet });
+
+        _trace.emplace_back(TracePacket { std::chrono::milliseconds(entry["time"].get<int64_t>()), std::move(packet) });
+    }
+
+    std::stable_sort(_trace.begin(), _trace.end(), [](const TracePacket& a, const TracePacket& b) {
+        return a.time < b.time;
+    });
+    std::cout << "Loaded " << _trace.size() << " packets from trace '" << path << "'" << std::endl;
+}
+
+void StubServer::build_datapackage()
+{
+    if(_settings.datapackage)
+    {
+        _datapackage = *_settings.datapackage;
+    }
+    else
+    {
+        json items = json::object();
+        for(int64_t i=0 ; i<ITEM_COUNT ; ++i)
+        {
+            char name[16];
+            std::snprintf(name, sizeof(name), "Item 0x%02X", static_cast<int>(i));
+            items[name] = ITEM_BASE_ID + i;
+        }
+
+        json locations = json::object();
+        for(int64_t i=0 ; i<LOCATION_COUNT ; ++i)
+            locations["Location " + std::to_string(LOCATION_BASE_ID + i)] = LOCATION_BASE_ID + i;
+
+        _datapackage = { { "item_name_to_id", items }, { "location_name_to_id", locations } };
+    }
+
+    // Checksum only needs to change with the contents, so that the client cache gets exercised across runs
+    _datapackage_checksum = "stub-" + std::to_string(std::hash<std::string>()(_datapackage.dump()));
+    _datapackage["checksum"] = _datapackage_checksum;
+}
+
+// =====================================================================================================
+
+void StubServer::on_open(websocketpp::connection_hdl hdl)
+{
+    if(_has_client)
+    {
+        std::error_code error;
+        _server.close(hdl, websocketpp::close::status::try_again_later, "Stub server only serves one client", error);
+        return;
+    }
+
+    _client = hdl;
+    _has_client = true;
+    _slot_connected = false;
+    std::string extensions = _server.get_con_from_hdl(hdl)->get_response_header("Sec-WebSocket-Extensions");
+    std::cout << "Client connected (compression: " << (extensions.empty() ? "none" : extensions) << ")" << std::endl;
+
+    this->send(json::array({{
+        { "cmd", "RoomInfo" },
+        { "version", version_json() },
+        { "generator_version", version_json() },
+        { "tags", json::array({ "AP" }) },
+        { "password", false },
+        { "permissions", { { "release", 2 }, { "collect", 2 }, { "remaining", 2 } } },
+        { "hint_cost", 10 },
+        { "location_check_points", 1 },
+        { "games", json::array({ _settings.game }) },
+        { "datapackage_checksums", { { _settings.game, _datapackage_checksum }, { "Archipelago", "stub-archipelago" } } },
+        { "seed_name", "stub" },
+        { "time", std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count() }
+    }}));
+}
+
+void StubServer::on_close(websocketpp::connection_hdl hdl)
+{
+    if(!_has_client || _client.owner_before(hdl) || hdl.owner_before(_client))
+        return;
+
+    this->print_report("Client disconnected");
+    _has_client = false;
+    _slot_connected = false;
+    _pending_pings.clear();
+}
+
+void StubServer::on_message(websocketpp::connection_hdl hdl, const Server::message_ptr& msg)
+{
+    if(!_has_client || _client.owner_before(hdl) || hdl.owner_before(_client))
+        return;
+
+    json packet = json::parse(msg->get_payload(), nullptr, false);
+    if(packet.is_discarded() || !packet.is_array())
+    {
+        std::cerr << "Received invalid packet: " << msg->get_payload() << std::endl;
+        return;
+    }
+
+    for(const json& command : packet)
+    {
+        if(command.is_object() && command["cmd"].is_string())
+            this->handle_command(command);
+        _messages_received += 1;
+    }
+}
+
+void StubServer::on_pong(websocketpp::connection_hdl, const std::string& payload)
+{
+    auto it = _pending_pings.find(std::strtoull(payload.c_str(), nullptr, 10));
+    if(it == _pending_pings.end())
+        return;
+
+    auto round_trip = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - it->second);
+    _ping_round_trips_us.emplace_back(static_cast<uint32_t>(round_trip.count()));
+    _pending_pings.erase(it);
+}
+
+void StubServer::handle_command(const json& command)
+{
+    const std::string cmd = command["cmd"];
+    if(cmd == "GetDataPackage")
+    {
+        json games = json::object();
+        std::vector<std::string> requested_games = command.value("games", std::vector<std::string>());
+        auto is_requested = [&requested_games](const std::string& game) {
+            return requested_games.empty()
+                || std::find(requested_games.begin(), requested_games.end(), game) != requested_games.end();
+        };
+
+        if(is_requested(_settings.game))
+            games[_settings.game] = _datapackage;
+        if(is_requested("Archipelago"))
+        {
+            games["Archipelago"] = {
+                { "item_name_to_id", { { "Nothing", -1 } } },
+                { "location_name_to_id", { { "Cheat Console", -1 }, { "Server", -2 } } },
+                { "checksum", "stub-archipelago" }
+            };
+        }
+        this->send(json::array({{ { "cmd", "DataPackage" }, { "data", { { "games", games } } } }}));
+    }
+    else if(cmd == "Connect")
+    {
+        _slot_name = command.value("name", "Player");
+        json slot_info = {
+            { std::to_string(CLIENT_SLOT), { { "name", _slot_name }, { "game", _settings.game }, { "type", 1 }, { "group_members", json::array() } } },
+            { std::to_string(OTHER_SLOT), { { "name", OTHER_PLAYER_NAME }, { "game", _settings.game }, { "type", 1 }, { "group_members", json::array() } } }
+        };
+        json players = json::array({
+            { { "team", 0 }, { "slot", CLIENT_SLOT }, { "alias", _slot_name }, { "name", _slot_name } },
+            { { "team", 0 }, { "slot", OTHER_SLOT }, { "alias", OTHER_PLAYER_NAME }, { "name", OTHER_PLAYER_NAME } }
+        });
+
+        json packet = json::array({{
+            { "cmd", "Connected" },
+            { "team", 0 },
+            { "slot", CLIENT_SLOT },
+            { "players", players },
+            { "missing_locations", json::array() },
+            { "checked_locations", _checked_locations },
+            { "slot_data", _settings.slot_data },
+            { "slot_info", slot_info },
+            { "hint_points", 0 }
+        }});
+        if(!_received_items.empty())
+            packet.push_back({ { "cmd", "ReceivedItems" }, { "index", 0 }, { "items", _received_items } });
+        this->send(packet);
+
+        _slot_connected = true;
+        _session_start = Clock::now();
+        _done_time.reset();
+        std::cout << "Slot '" << _slot_name << "' connected" << std::endl;
+    }
+    else if(cmd == "Sync")
+    {
+        this->send(json::array({{ { "cmd", "ReceivedItems" }, { "index", 0 }, { "items", _received_items } }}));
+    }
+    else if(cmd == "LocationScouts")
+    {
+        json locations = json::array();
+        for(const json& location : command.value("locations", json::array()))
+        {
+            // Every location holds an item for the other player, to make sure the client resolves foreign names
+            int64_t index = (location.get<int64_t>() - LOCATION_BASE_ID) % ITEM_COUNT;
+            locations.push_back({
+                { "item", ITEM_BASE_ID + (index < 0 ? index + ITEM_COUNT : index) },
+                { "location", location },
+                { "player", OTHER_SLOT },
+                { "flags", 0 }
+            });
+        }
+        this->send(json::array({{ { "cmd", "LocationInfo" }, { "locations", locations } }}));
+    }
+    else if(cmd == "LocationChecks")
+    {
+        json new_locations = json::array();
+        for(const json& location : command.value("locations", json::array()))
+        {
+            _checks_received += 1;
+            if(std::find(_checked_locations.begin(), _checked_locations.end(), location.get<int64_t>()) != _checked_locations.end())
+                continue;
+            _checked_locations.emplace_back(location.get<int64_t>());
+            new_locations.push_back(location);
+        }
+        if(!new_locations.empty())
+            this->send(json::array({{ { "cmd", "RoomUpdate" }, { "checked_locations", new_locations } }}));
+    }
+    else if(cmd == "Bounce")
+    {
+        json bounced = command;
+        bounced["cmd"] = "Bounced";
+        this->send(json::array({ bounced }));
+    }
+    else if(cmd == "Say")
+    {
+        std::string text = _slot_name + ": " + command.value("text", "");
+        this->send(json::array({{
+            { "cmd", "PrintJSON" },
+            { "type", "Chat" },
+            { "team", 0 },
+            { "slot", CLIENT_SLOT },
+            { "message", command.value("text", "") },
+            { "data", json::array({ { { "text", text } } }) }
+        }}));
+    }
+}
+
+void StubServer::send(const json& commands)
+{
+    if(!_has_client)
+        return;
+
+    std::string payload = commands.dump();
+    std::error_code error;
+    _server.send(_client, payload, websocketpp::frame::opcode::text, error);
+    if(error)
+    {
+        std::cerr << "Could not send packet: " << error.message() << std::endl;
+        return;
+    }
+
+    _messages_sent += commands.size();
+    _bytes_sent += payload.size();
+}
+
+// =====================================================================================================
+
+void StubServer::on_tick()
+{
+    static Clock::time_point last_report = Clock::now();
+    static Clock::time_point last_ping = Clock::now();
+
+    if(_has_client && _slot_connected)
+    {
+        this->send_floods();
+        this->send_trace_packets();
+
+        if(Clock::now() - last_ping >= _settings.ping_interval)
+        {
+            this->send_ping();
+            last_ping = Clock::now();
+        }
+
+        if(!_done_time && this->everything_sent())
+            _done_time = Clock::now();
+    }
+
+    if(Clock::now() - last_report >= REPORT_PERIOD && _slot_connected)
+    {
+        this->print_report("Progress");
+        last_report = Clock::now();
+    }
+
+    if(_done_time && Clock::now() - *_done_time >= std::chrono::seconds(_settings.linger_seconds))
+    {
+        this->print_report("Session over");
+        _server.stop_listening();
+        if(_has_client)
+        {
+            std::error_code error;
+            _server.close(_client, websocketpp::close::status::normal, "Session over", error);
+        }
+        _server.stop();
+        return;
+    }
+
+    _server.set_timer(TICK_MILLIS, [this](const std::error_code& error) { if(!error) this->on_tick(); });
+}
+
+/**
+ * Send everything the floods should have sent since the start of the session, all in one packet as the real
+ * server would do when several messages are ready at once
+ */
+void StubServer::send_floods()
+{
+    double elapsed = seconds_since(_session_start);
+    auto due_count = [elapsed](const FloodState& flood) -> uint32_t {
+        if(flood.settings.rate <= 0.0)
+            return flood.settings.count;
+        return std::min(flood.settings.count, static_cast<uint32_t>(flood.settings.rate * elapsed));
+    };
+
+    json packet = json::array();
+
+    uint32_t due_items = due_count(_items);
+    if(due_items > _items.sent)
+    {
+        json items = json::array();
+        int first_index = static_cast<int>(_received_items.size());
+        for( ; _items.sent < due_items ; ++_items.sent)
+        {
+            json item = {
+                { "item", _settings.flood_item_id },
+                { "location", LOCATION_BASE_ID + (_items.sent % LOCATION_COUNT) },
+                { "player", OTHER_SLOT },
+                { "flags", 0 }
+            };
+            _received_items.emplace_back(item);
+            items.push_back(item);
+        }
+        packet.push_back({ { "cmd", "ReceivedItems" }, { "index", first_index }, { "items", items } });
+    }
+
+    // Chat flood alternates plain chat lines and item send messages, the latter needing names to be resolved
+    for(uint32_t due_chat = due_count(_chat) ; _chat.sent < due_chat ; ++_chat.sent)
+    {
+        if(_chat.sent % 2 == 0)
+        {
+            std::string message = "Stub chat line #" + std::to_string(_chat.sent);
+            packet.push_back({
+                { "cmd", "PrintJSON" }, { "type", "Chat" }, { "team", 0 }, { "slot", OTHER_SLOT }, { "message", message },
+                { "data", json::array({ { { "text", std::string(OTHER_PLAYER_NAME) + ": " + message } } }) }
+            });
+        }
+        else
+        {
+            int64_t location = LOCATION_BASE_ID + (_chat.sent % LOCATION_COUNT);
+            int64_t item = ITEM_BASE_ID + (_chat.sent % ITEM_COUNT);
+            packet.push_back({
+                { "cmd", "PrintJSON" }, { "type", "ItemSend" }, { "receiving", OTHER_SLOT },
+                { "item", { { "item", item }, { "location", location }, { "player", CLIENT_SLOT }, { "flags", 1 } } },
+                { "data", json::array({
+                    { { "type", "player_id" }, { "text", std::to_string(CLIENT_SLOT) } },
+                    { { "text", " sent " } },
+                    { { "type", "item_id" }, { "text", std::to_string(item) }, { "player", OTHER_SLOT }, { "flags", 1 } },
+                    { { "text", " to " } },
+                    { { "type", "player_id" }, { "text", std::to_string(OTHER_SLOT) } },
+                    { { "text", " (" } },
+                    { { "type", "location_id" }, { "text", std::to_string(location) }, { "player", CLIENT_SLOT } },
+                    { { "text", ")" } }
+                }) }
+            });
+        }
+    }
+
+    for(uint32_t due_deaths = due_count(_deaths) ; _deaths.sent < due_deaths ; ++_deaths.sent)
+    {
+        packet.push_back({
+            { "cmd", "Bounced" },
+            { "tags", json::array({ "DeathLink" }) },
+            { "data", {
+                { "time", std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count() },
+                { "source", OTHER_PLAYER_NAME },
+                { "cause", "Stub death #" + std::to_string(_deaths.sent) }
+            } }
+        });
+    }
+
+    if(!packet.empty())
+        this->send(packet);
+}
+
+void StubServer::send_trace_packets()
+{
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - _session_start);
+    while(!_trace.empty() && _trace.front().time <= elapsed)
+    {
+        this->send(_trace.front().packet);
+        _trace.pop_front();
+    }
+}
+
+void StubServer::send_ping()
+{
+    uint64_t ping_id = _next_ping_id++;
+    std::error_code error;
+    _server.ping(_client, std::to_string(ping_id), error);
+    if(!error)
+        _pending_pings[ping_id] = Clock::now();
+
+    // Pings that never got an answer should not pile up forever
+    while(_pending_pings.size() > 1000)
+        _pending_pings.erase(_pending_pings.begin());
+}
+
+bool StubServer::everything_sent() const
+{
+    bool has_something_to_send = _items.settings.count || _chat.settings.count || _deaths.settings.count
+                              || !_settings.trace_path.empty();
+    if(!has_something_to_send)
+        return false;
+
+    return _items.sent == _items.settings.count && _chat.sent == _chat.settings.count
+        && _deaths.sent == _deaths.settings.count && _trace.empty();
+}
+
+void StubServer::print_report(const std::string& title)
+{
+    double elapsed = _slot_connected ? seconds_since(_session_start) : 0.0;
+    double rate = (elapsed > 0.0) ? static_cast<double>(_messages_sent) / elapsed : 0.0;
+
+    std::vector<uint32_t> round_trips = _ping_round_trips_us;
+    std::sort(round_trips.begin(), round_trips.end());
+    char line[512];
+    std::snprintf(line, sizeof(line),
+                  "[%s] %.1fs | sent %llu msgs (%.0f msg/s, %.1f KiB) | items %u/%u, chat %u/%u, deaths %u/%u | "
+                  "received %llu msgs, %llu checks | ping rtt p50 %.2fms p95 %.2fms p99 %.2fms max %.2fms (%zu samples, %zu lost)",
+                  title.c_str(), elapsed,
+                  static_cast<unsigned long long>(_messages_sent), rate, static_cast<double>(_bytes_sent) / 1024.0,
+                  _items.sent, _items.settings.count, _chat.sent, _chat.settings.count, _deaths.sent, _deaths.settings.count,
+                  static_cast<unsigned long long>(_messages_received), static_cast<unsigned long long>(_checks_received),
+                  percentile(round_trips, 0.50), percentile(round_trips, 0.95), percentile(round_trips, 0.99),
+                  percentile(round_trips, 1.0),
+                  round_trips.size(), _pending_pings.size() > 1 ? _pending_pings.size() - 1 : 0);
+    std::cout << line << std::endl;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <websocketpp/config/asio_no_tls.hpp>
+#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
+#include <websocketpp/server.hpp>
+
+using nlohmann::json;
+
+/**
+ * Stream of messages sent to the client at a fixed rate, starting as soon as it is connected to its slot
+ */
+struct FloodSettings
+{
+    uint32_t count = 0;
+    /// Messages per second
+    double rate = 0.0;
+};
+
+struct StubServerSettings
+{
+    uint16_t port = 38281;
+    std::string game = "Landstalker - The Treasures of King Nole";
+    /// Slot data given to the client on connection, needs to contain everything the client reads from it
+    json slot_data = { { "seed", 0 }, { "goal", 0 }, { "death_link", 1 } };
+    /// Datapackage of the game, names are generated if none is given
+    std::optional<json> datapackage;
+
+    FloodSettings items;
+    FloodSettings chat;
+    FloodSettings deaths;
+    /// Item given to the client by the item flood (EkeEke by default)
+    int64_t flood_item_id = 4000;
+
+    /// File containing server packets to replay to the client (see StubServer::load_trace)
+    std::string trace_path;
+
+    /// Interval between two websocket pings used to measure how fast the client answers
+    std::chrono::milliseconds ping_interval { 100 };
+    /// Stop the server once all floods and trace were sent and that many seconds have elapsed since
+    uint32_t linger_seconds = 5;
+};
+
+struct StubServerConfig : public websocketpp::config::asio
+{
+    /// Compression is used whenever the client offers it, just like the real server does
+    struct permessage_deflate_config {};
+    typedef websocketpp::extensions::permessage_deflate::enabled<permessage_deflate_config> permessage_deflate_type;
+};
+
+/**
+ * Stand-in for an Archipelago server speaking just enough of the protocol for ArchipelagoInterface to connect,
+ * scout locations, send checks and receive items, chat lines and deathlinks.
+ *
+ * It only serves one client at a time, and is meant to flood it with messages at controlled rates to measure
+ * throughput, and how long the client takes to answer websocket pings while under load.
+ */
+class StubServer
+{
+private:
+    using Server = websocketpp::server<StubServerConfig>;
+    using Clock = std::chrono::steady_clock;
+
+    struct TracePacket
+    {
+        std::chrono::milliseconds time;
+        json packet;
+    };
+
+    struct FloodState
+    {
+        FloodSettings settings;
+        uint32_t sent = 0;
+    };
+
+    StubServerSettings _settings;
+    Server _server;
+    websocketpp::connection_hdl _client;
+    bool _has_client = false;
+    bool _slot_connected = false;
+    std::string _slot_name;
+    bool _finished = false;
+
+    json _datapackage;
+    std::string _datapackage_checksum;
+    std::vector<json> _received_items;
+    std::vector<int64_t> _checked_locations;
+
+    FloodState _items;
+    FloodState _chat;
+    FloodState _deaths;
+    std::deque<TracePacket> _trace;
+
+    Clock::time_point _session_start;
+    std::optional<Clock::time_point> _done_time;
+
+    uint64_t _next_ping_id = 0;
+    std::map<uint64_t, Clock::time_point> _pending_pings;
+    std::vector<uint32_t> _ping_round_trips_us;
+    uint64_t _messages_sent = 0;
+    uint64_t _bytes_sent = 0;
+    uint64_t _checks_received = 0;
+    uint64_t _messages_received = 0;
+
+public:
+    explicit StubServer(StubServerSettings settings);
+
+    /// Run the server until the session is over (or forever if there is nothing to send)
+    void run();
+
+private:
+    void load_trace(const std::string& path);
+    void build_datapackage();
+
+    void on_open(websocketpp::connection_hdl hdl);
+    void on_close(websocketpp::connection_hdl hdl);
+    void on_message(websocketpp::connection_hdl hdl, const Server::message_ptr& msg);
+    void on_pong(websocketpp::connection_hdl hdl, const std::string& payload);
+
+    void handle_command(const json& command);
+    void send(const json& commands);
+
+    void on_tick();
+    void send_floods();
+    void send_trace_packets();
+    void send_ping();
+    [[nodiscard]] bool everything_sent() const;
+
+    void print_report(const std::string& title);
+};
@@ -0,0 +1,376 @@
+/**
+ * Build-time generator turning the static JSON data of the client into constexpr C++ tables, so that none of it has
+ * to be parsed at startup. Each table type is generated into its own header:
+ *
+ *  - `locations` (from `item_source.json`): dense location index, containing
+ *      - a single read-only string pool holding all location names and URLs (each one NUL-terminated)
+ *      - the offsets of each location's name and URL inside that pool, indexed by location index
+ *      - the definition (id, checked flag) of each location, indexed by location index
+ *      - a perfect hash over location names (hash and displace), mapping each name to its location index
+ *    Location indices follow the alphabetical order of location names, which is the order the client lists them in.
+ *
+ *  - `regions` (from `trackable_regions.json` and `item_source.json`): map tracker regions, with the names of their
+ *    locations already resolved into location indices
+ *
+ *  - `items` (from `trackable_items.json`): item tracker items
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../../src/location_name_hash.hpp"
+
+constexpr uint16_t EMPTY_SLOT = 0xFFFF;
+constexpr uint32_t MAX_DISPLACEMENT = 100000;
+
+constexpr uint16_t BASE_LOCATION_ID = 4000;
+constexpr uint16_t BASE_GROUND_LOCATION_ID = BASE_LOCATION_ID + 256;
+constexpr uint16_t BASE_SHOP_LOCATION_ID = BASE_GROUND_LOCATION_ID + 30;
+constexpr uint16_t BASE_REWARD_LOCATION_ID = BASE_SHOP_LOCATION_ID + 50;
+
+struct LocationEntry
+{
+    std::string name;
+    std::string url;
+    uint16_t id = 0xFFFF;
+    uint16_t checked_flag_byte = 0x0000;
+    uint8_t checked_flag_bit = 0x00;
+};
+
+static nlohmann::json read_json_file(const std::string& path)
+{
+    std::ifstream file(path);
+    if(!file)
+        throw std::runtime_error("Could not open '" + path + "'");
+    return nlohmann::json::parse(file);
+}
+
+static uint32_t next_power_of_two(size_t value)
+{
+    uint32_t result = 1;
+    while(result < value)
+        result <<= 1;
+    return result;
+}
+
+/// Escape given string as a C++ string literal, using octal escapes since they can't swallow the next characters
+static std::string escape(const std::string& str)
+{
+    std::string result;
+    for(char c : str)
+    {
+        auto byte = static_cast<uint8_t>(c);
+        if(c == '"' || c == '\\')
+        {
+            result += '\\';
+            result += c;
+        }
+        else if(byte < 0x20 || byte >= 0x7F)
+        {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\%03o", byte);
+            result += buffer;
+        }
+        else
+            result += c;
+    }
+    return result;
+}
+
+static std::string string_literal(const std::string& str)
+{
+    return "\"" + escape(str) + "\"";
+}
+
+static std::string float_literal(double value)
+{
+    std::ostringstream literal;
+    literal << std::setprecision(9) << value;
+    std::string str = literal.str();
+    if(str.find_first_of(".e") == std::string::npos)
+        str += ".0";
+    return str + "f";
+}
+
+template<typename T>
+static void write_array(std::ostream& out, const char* type, const char* name, const std::vector<T>& values)
+{
+    out << "constexpr " << type << " " << name << "[] = {";
+    for(size_t i=0 ; i<values.size() ; ++i)
+    {
+        if(i % 16 == 0)
+            out << "\n    ";
+        out << values[i] << ",";
+    }
+    out << "\n};\n\n";
+}
+
+static void write_header_start(std::ostream& out, const std::vector<std::string>& input_paths)
+{
+    out << "// Generated from";
+    for(const std::string& input_path : input_paths)
+        out << " " << input_path;
+    out << " by data_table_generator, do not edit.\n\n";
+    out << "#pragma once\n\n";
+    out << "#include <cstdint>\n";
+    out << "#include \"../data_tables.hpp\"\n\n";
+}
+
+/// @return all locations from given item sources file, by order of location index
+static std::vector<LocationEntry> read_locations(const std::string& item_sources_path)
+{
+    std::vector<LocationEntry> locations;
+    for(const nlohmann::json& item_source : read_json_file(item_sources_path))
+    {
+        LocationEntry location { item_source.at("name"), item_source.value("url", "") };
+
+        const std::string& type = item_source.at("type");
+        if(type == "chest")
+        {
+            uint8_t chest_id = item_source.at("chestId");
+            location.checked_flag_byte = 0x1080 + (chest_id / 8);
+            location.checked_flag_bit = chest_id % 8;
+            location.id = BASE_LOCATION_ID + chest_id;
+        }
+        else if(type == "ground")
+        {
+            uint8_t ground_id = item_source.at("groundItemId");
+            location.checked_flag_byte = 0x1060 + (ground_id / 8);
+            location.checked_flag_bit = ground_id % 8;
+            location.id = BASE_GROUND_LOCATION_ID + ground_id;
+        }
+        else if(type == "shop")
+        {
+            uint8_t shop_item_id = item_source.at("shopItemId");
+            location.checked_flag_byte = 0x1064 + (shop_item_id / 8);
+            location.checked_flag_bit = shop_item_id % 8;
+            location.id = BASE_SHOP_LOCATION_ID + shop_item_id;
+        }
+        else if(type == "reward")
+        {
+            uint8_t reward_id = item_source.at("rewardId");
+            const std::string& byte_str = item_source.at("flag").at("byte");
+            location.checked_flag_byte = std::stoul(byte_str.substr(2), nullptr, 16);
+            location.checked_flag_bit = item_source.at("flag").at("bit");
+            location.id = BASE_REWARD_LOCATION_ID + reward_id;
+        }
+
+        locations.emplace_back(location);
+    }
+
+    std::sort(locations.begin(), locations.end(), [](const LocationEntry& a, const LocationEntry& b) {
+        return a.name < b.name;
+    });
+
+    for(size_t i=1 ; i<locations.size() ; ++i)
+        if(locations[i].name == locations[i-1].name)
+            throw std::runtime_error("Duplicate location name '" + locations[i].name + "'");
+    if(locations.size() >= EMPTY_SLOT)
+        throw std::runtime_error("Too many locations to be indexed on 16 bits");
+
+    return locations;
+}
+
+static void write_locations(std::ostream& out, const std::vector<std::string>& input_paths)
+{
+    std::vector<LocationEntry> locations = read_locations(input_paths.at(0));
+
+    // Build the string pool
+    std::string pool;
+    std::vector<uint32_t> name_offsets;
+    std::vector<uint32_t> url_offsets;
+    for(const LocationEntry& location : locations)
+    {
+        name_offsets.emplace_back(pool.size());
+        pool += location.name;
+        pool += '\0';
+    }
+    for(const LocationEntry& location : locations)
+    {
+        url_offsets.emplace_back(pool.size());
+        pool += location.url;
+        pool += '\0';
+    }
+    if(pool.size() > 0xFFFF)
+        throw std::runtime_error("String pool is too big to be addressed on 16 bits");
+
+    // Distribute names into buckets, then find for each bucket (biggest ones first) a hash seed sending all of its
+    // names into free slots
+    uint32_t bucket_count = next_power_of_two(std::max<size_t>(locations.size() / 2, 1));
+    uint32_t slot_count = next_power_of_two(locations.size() + locations.size() / 2);
+
+    std::vector<std::vector<uint16_t>> buckets(bucket_count);
+    for(uint16_t i=0 ; i<locations.size() ; ++i)
+        buckets[location_name_hash(locations[i].name, 0) & (bucket_count - 1)].emplace_back(i);
+
+    std::vector<uint32_t> bucket_order(bucket_count);
+    for(uint32_t i=0 ; i<bucket_count ; ++i)
+        bucket_order[i] = i;
+    std::stable_sort(bucket_order.begin(), bucket_order.end(), [&buckets](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<uint32_t> displacements(bucket_count, 0);
+    std::vector<uint16_t> slots(slot_count, EMPTY_SLOT);
+    for(uint32_t bucket_id : bucket_order)
+    {
+        const std::vector<uint16_t>& bucket = buckets[bucket_id];
+        if(bucket.empty())
+            break;
+
+        bool placed = false;
+        for(uint32_t displacement = 1 ; displacement < MAX_DISPLACEMENT && !placed ; ++displacement)
+        {
+            std::vector<uint32_t> candidate_slots;
+            for(uint16_t location_index : bucket)
+            {
+                uint32_t slot = location_name_hash(locations[location_index].name, displacement) & (slot_count - 1);
+                if(slots[slot] != EMPTY_SLOT || std::find(candidate_slots.begin(), candidate_slots.end(), slot) != candidate_slots.end())
+                    break;
+                candidate_slots.emplace_back(slot);
+            }
+            if(candidate_slots.size() != bucket.size())
+                continue;
+
+            for(size_t i=0 ; i<bucket.size() ; ++i)
+                slots[candidate_slots[i]] = bucket[i];
+            displacements[bucket_id] = displacement;
+            placed = true;
+        }
+
+        if(!placed)
+            throw std::runtime_error("Could not find a perfect hash for location names");
+    }
+
+    out << "constexpr uint16_t LOCATION_COUNT = " << locations.size() << ";\n";
+    out << "constexpr uint32_t LOCATION_HASH_BUCKET_COUNT = " << bucket_count << ";\n";
+    out << "constexpr uint32_t LOCATION_HASH_SLOT_COUNT = " << slot_count << ";\n\n";
+
+    out << "constexpr char LOCATION_STRING_POOL[] =";
+    size_t entry_start = 0;
+    for(size_t i=0 ; i<pool.size() ; ++i)
+    {
+        if(pool[i] != '\0')
+            continue;
+        out << "\n    \"" << escape(pool.substr(entry_start, i - entry_start)) << "\\0\"";
+        entry_start = i + 1;
+    }
+    out << ";\n\n";
+
+    write_array(out, "uint16_t", "LOCATION_NAME_OFFSETS", name_offsets);
+    write_array(out, "uint16_t", "LOCATION_URL_OFFSETS", url_offsets);
+
+    out << "constexpr LocationDefinition LOCATION_DEFINITIONS[] = {\n";
+    for(const LocationEntry& location : locations)
+    {
+        out << "    { " << location.id << ", 0x" << std::hex << location.checked_flag_byte << std::dec
+            << ", " << (int)location.checked_flag_bit << " },\n";
+    }
+    out << "};\n\n";
+
+    write_array(out, "uint32_t", "LOCATION_HASH_DISPLACEMENTS", displacements);
+    write_array(out, "uint16_t", "LOCATION_HASH_SLOTS", slots);
+}
+
+static void write_regions(std::ostream& out, const std::vector<std::string>& input_paths)
+{
+    nlohmann::json regions = read_json_file(input_paths.at(0));
+    std::vector<LocationEntry> locations = read_locations(input_paths.at(1));
+
+    std::vector<uint16_t> region_locations;
+    std::ostringstream definitions;
+    for(const nlohmann::json& region : regions)
+    {
+        auto first_location = static_cast<uint16_t>(region_locations.size());
+        for(const std::string& location_name : region.value("locations", std::vector<std::string>()))
+        {
+            auto it = std::lower_bound(locations.begin(), locations.end(), location_name,
+                                       [](const LocationEntry& loc, const std::string& name) { return loc.name < name; });
+            if(it == locations.end() || it->name != location_name)
+            {
+                std::cerr << "Warning: unknown location '" << location_name << "' in trackable regions" << std::endl;
+                continue;
+            }
+            region_locations.emplace_back(static_cast<uint16_t>(it - locations.begin()));
+        }
+
+        uint8_t hidden_for_goals = 0;
+        for(uint8_t goal_id : region.value("hiddenForGoals", std::vector<uint8_t>()))
+            hidden_for_goals |= (1 << goal_id);
+
+        definitions << "    { " << string_literal(region.value("name", ""))
+                    << ", " << region.value("x", 0) << ", " << region.value("y", 0)
+                    << ", " << region.value("width", 1) << ", " << region.value("height", 1)
+                    << ", " << first_location << ", " << region_locations.size() - first_location
+                    << ", " << (int)hidden_for_goals
+                    << ", " << string_literal(region.value("darkDungeonName", "_"))
+                    << ", " << string_literal(region.value("spawnLocationName", "_"))
+                    << ", " << string_literal(region.value("teleportTreeName", ""))
+                    << " },\n";
+    }
+
+    write_array(out, "uint16_t", "TRACKABLE_REGION_LOCATIONS", region_locations);
+    out << "constexpr TrackableRegionDefinition TRACKABLE_REGIONS[] = {\n" << definitions.str() << "};\n";
+}
+
+static void write_items(std::ostream& out, const std::vector<std::string>& input_paths)
+{
+    nlohmann::json items = read_json_file(input_paths.at(0));
+
+    out << "constexpr TrackableItemDefinition TRACKABLE_ITEMS[] = {\n";
+    for(const nlohmann::json& item : items)
+    {
+        out << "    { " << string_literal(item.value("name", ""))
+            << ", " << string_literal(item.value("image", ""))
+            << ", " << (int)item.value("itemId", uint8_t(0)) << ", " << (int)item.value("quantity", uint8_t(0))
+            << ", " << float_literal(item.value("x", 0.0)) << ", " << float_literal(item.value("y", 0.0))
+            << " },\n";
+    }
+    out << "};\n";
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 4)
+    {
+        std::cerr << "Usage: data_table_generator <locations|regions|items> <output.hxx> <input.json>..." << std::endl;
+        return 1;
+    }
+
+    std::string table_type = argv[1];
+    std::string output_path = argv[2];
+    std::vector<std::string> input_paths(argv + 3, argv + argc);
+
+    try
+    {
+        std::ostringstream out;
+        write_header_start(out, input_paths);
+        if(table_type == "locations")
+            write_locations(out, input_paths);
+        else if(table_type == "regions")
+            write_regions(out, input_paths);
+        else if(table_type == "items")
+            write_items(out, input_paths);
+        else
+            throw std::runtime_error("Invalid table type '" + table_type + "'");
+
+        std::ofstream output_file(output_path);
+        output_file << out.str();
+        if(!output_file)
+            throw std::runtime_error("Could not write '" + output_path + "'");
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
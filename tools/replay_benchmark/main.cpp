@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "emulator_interfaces/replay_emulator_interface.hpp"
+#include "game_polling.hpp"
+
+static const char* USAGE =
+    "Usage: replay_benchmark <trace> [options]\n"
+    "  <trace>                     Emulator session recorded with the client's !record console command\n"
+    "  --items <count>             Number of received items waiting to be delivered when replay starts (default: 0)\n"
+    "  --item-id <id>              Id of these received items (default: 0x2D, EkeEke)\n"
+    "  --deathlink                 Poll the game as if deathlink was enabled\n";
+
+// Globals the poll tasks work on, which are normally owned by the client (see game_polling.hpp)
+GameState game_state;
+MultiworldInterface* multiworld = nullptr;
+EmulatorInterface* emulator = nullptr;
+PollScheduler scheduler;
+PollScheduler::TaskId archipelago_task;
+PollScheduler::TaskId item_delivery_task;
+MpscQueue<SessionEvent> game_events;
+MpscQueue<SessionEvent> ui_events;
+
+struct BenchmarkSettings
+{
+    std::string trace_path;
+    uint16_t item_count = 0;
+    uint8_t item_id = 0x2D;
+    bool deathlink = false;
+};
+
+struct BenchmarkTask
+{
+    const char* name;
+    void (*callback)();
+    std::vector<std::chrono::nanoseconds> durations;
+};
+
+static BenchmarkSettings parse_arguments(int argc, char* argv[])
+{
+    BenchmarkSettings settings;
+    for(int i=1 ; i<argc ; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "--help" || arg == "-h")
+        {
+            std::cout << USAGE;
+            std::exit(0);
+        }
+        if(arg == "--deathlink")
+        {
+            settings.deathlink = true;
+            continue;
+        }
+        if(!arg.starts_with("--"))
+        {
+            settings.trace_path = arg;
+            continue;
+        }
+        if(i+1 >= argc)
+            throw std::runtime_error("Missing value for argument '" + arg + "'");
+
+        std::string value = argv[++i];
+        if(arg == "--items")            settings.item_count = static_cast<uint16_t>(std::stoul(value));
+        else if(arg == "--item-id")     settings.item_id = static_cast<uint8_t>(std::stoul(value, nullptr, 0));
+        else
+            throw std::runtime_error("Unknown argument '" + arg + "'");
+    }
+
+    if(settings.trace_path.empty())
+        throw std::runtime_error("No trace file given");
+    return settings;
+}
+
+static void print_report(const std::vector<BenchmarkTask>& tasks, uint32_t tick_count)
+{
+    using std::chrono::duration;
+    auto to_us = [](std::chrono::nanoseconds ns) { return duration<double, std::micro>(ns).count(); };
+
+    std::cout << "Replayed " << tick_count << " ticks\n";
+    std::cout << std::left << std::setw(16) << "task" << std::right << std::setw(12) << "mean (us)"
+              << std::setw(12) << "p50 (us)" << std::setw(12) << "p99 (us)" << std::setw(12) << "max (us)" << "\n";
+
+    for(const BenchmarkTask& task : tasks)
+    {
+        std::vector<std::chrono::nanoseconds> sorted = task.durations;
+        if(sorted.empty())
+            continue;
+        std::sort(sorted.begin(), sorted.end());
+
+        std::chrono::nanoseconds total(0);
+        for(std::chrono::nanoseconds d : sorted)
+            total += d;
+
+        std::cout << std::left << std::setw(16) << task.name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << to_us(total / sorted.size())
+                  << std::setw(12) << to_us(sorted[sorted.size() / 2])
+                  << std::setw(12) << to_us(sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)])
+                  << std::setw(12) << to_us(sorted.back()) << "\n";
+    }
+}
+
+/**
+ * Feed a recorded emulator session through the poll tasks of the client as fast as possible, without any UI,
+ * emulator or server, and report how long each task takes per tick.
+ */
+int main(int argc, char* argv[])
+{
+    BenchmarkSettings settings;
+    try
+    {
+        settings = parse_arguments(argc, argv);
+        emulator = new ReplayEmulatorInterface(settings.trace_path, false);
+    }
+    catch(EmulatorException& e)
+    {
+        std::cerr << "Error: " << e.message() << "\n";
+        return EXIT_FAILURE;
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n" << USAGE;
+        return EXIT_FAILURE;
+    }
+
+    game_state.has_deathlink(settings.deathlink);
+    for(uint16_t i=0 ; i<settings.item_count ; ++i)
+    {
+        game_state.set_received_item(i, settings.item_id);
+        pending_item_timestamps[i] = PendingItemTimestamps { .received = LatencyStats::Clock::now() };
+    }
+
+    // Same order as the scheduler would run them if they were all due at once
+    std::vector<BenchmarkTask> tasks = {
+        { "item_delivery", poll_item_delivery, {} },
+        { "locations", poll_locations, {} },
+        { "inventory", poll_inventory, {} }
+    };
+
+    // Replay throws once the whole trace was played back
+    uint32_t tick_count = 0;
+    try
+    {
+        while(true)
+        {
+            for(BenchmarkTask& task : tasks)
+            {
+                auto start = std::chrono::steady_clock::now();
+                task.callback();
+                task.durations.emplace_back(std::chrono::steady_clock::now() - start);
+            }
+            ++tick_count;
+
+            // Nothing consumes these events here, only keep them from piling up
+            while(game_events.pop()) {}
+            while(ui_events.pop()) {}
+        }
+    }
+    catch(EmulatorException&) {}
+
+    print_report(tasks, tick_count);
+    delete emulator;
+    return EXIT_SUCCESS;
+}